@@ -1,20 +1,12 @@
 #include <util.hpp>
 
-#include <map>
-
 namespace aoc {
 namespace {
-    const std::map<std::string_view, size_t> num_map {
-        { "one", 1 },
-        { "two", 2 },
-        { "three", 3 },
-        { "four", 4 },
-        { "five", 5 },
-        { "six", 6 },
-        { "seven", 7 },
-        { "eight", 8 },
-        { "nine", 9 }
-    };
+    // pattern i stands for the value i % 9 + 1
+    constexpr auto digit_patterns = std::to_array<std::string_view>({ "1", "2", "3", "4", "5", "6", "7", "8", "9",
+        "one", "two", "three", "four", "five", "six", "seven", "eight", "nine" });
+
+    constexpr aho_corasick<digit_patterns.size(), num_trie_states(digit_patterns)> digit_matcher { digit_patterns };
 
     size_t extract_line_with_digits(const std::string_view line)
     {
@@ -33,35 +25,20 @@ namespace {
             std::plus {});
     }
 
-    size_t extract_line_with_digits_and_words(const std::string_view line)
+    constexpr size_t extract_line_with_digits_and_words(const std::string_view line)
     {
-        if (line.empty())
-            return 0;
-
-        const auto reversed_line = line | std::views::reverse;
+        const auto first = digit_matcher.find_first(line);
+        const auto last = digit_matcher.find_last(line);
 
-        std::map<size_t, size_t> pos_and_values;
-
-        const auto first_digit = std::ranges::find_if(line, is_digit);
-        if (first_digit != line.end())
-            pos_and_values[std::distance(line.begin(), first_digit)] = std::stoi(std::string { *first_digit });
-
-        const auto last_digit = std::ranges::find_if(reversed_line, is_digit);
-        if (last_digit != reversed_line.end())
-            pos_and_values[line.size() - std::distance(reversed_line.begin(), last_digit)] = std::stoi(
-                std::string { *last_digit });
-
-        for (size_t i = 0; i < line.size(); ++i) {
-            for (auto& [key, value] : num_map) {
-                if (line.substr(i, key.size()) == key) {
-                    pos_and_values[i] = value;
-                    break;
-                }
-            }
-        }
+        if (!first || !last)
+            return 0;
 
-        return pos_and_values.begin()->second * 10 + pos_and_values.rbegin()->second;
+        return (first->pattern % 9 + 1) * 10 + last->pattern % 9 + 1;
     }
+
+    static_assert(extract_line_with_digits_and_words("xtwone3four") == 24);
+    static_assert(extract_line_with_digits_and_words("zoneight234") == 14);
+    static_assert(extract_line_with_digits_and_words("7pqrstsixteen") == 76);
 }
 
 size_t first_task()
@@ -1,43 +1,45 @@
+#include <parse.hpp>
 #include <util.hpp>
 
-#include <map>
-#include <spanstream>
+#include <utility>
 
 namespace aoc {
 namespace {
+    enum class cube_color {
+        red,
+        green,
+        blue
+    };
+
     struct draw {
-        std::string color;
         size_t quantity;
+        cube_color color;
     };
 
+    using quantities = std::array<size_t, 3>;
+
+    // a game only matters through the maximum quantity drawn per color
     struct game {
         size_t id {};
-        std::vector<std::vector<draw>> draws;
+        quantities max_quantities {};
     };
 
     game parse_game(const std::string_view line)
     {
-        game g;
-
-        constexpr std::string_view prefix { "Game " };
-
-        size_t offset = std::string_view { "Game" }.length();
-        offset += static_cast<size_t>((std::ispanstream(line.substr(offset)) >> g.id).tellg()) + 1;
-
-        for (const auto game_str : std::views::split(line.substr(offset), ';') | std::views::transform(as_string_view)) {
-            std::vector<draw> draws;
+        constexpr auto color_parser = parse::keywords<cube_color>(std::to_array<std::string_view>({ "red", "green", "blue" }));
+        constexpr auto draw_parser = parse::into<draw>(parse::seq(parse::spaces {}, parse::unsigned_number<>, " ", color_parser));
 
-            for (const auto draw_sv : std::views::split(game_str, ',') | std::views::transform(as_string_view)) {
-
-                draw d;
-                std::ispanstream { draw_sv } >> d.quantity >> d.color;
-                draws.push_back(d);
-            }
+        constexpr auto max_per_color = [](quantities q, const draw& d) {
+            auto& max = q[std::to_underlying(d.color)];
+            max = std::max(max, d.quantity);
+            return q;
+        };
 
-            g.draws.emplace_back(std::move(draws));
-        }
+        // draws within a set are separated by ',' and sets by ';', neither matters for the maximum
+        constexpr auto game_parser = parse::into<game>(parse::seq("Game ", parse::unsigned_number<>, ":",
+            parse::fold_separated(draw_parser, parse::one_of_chars { ",;" }, quantities {}, max_per_color)));
 
-        return g;
+        return parse::parse_line(game_parser, line);
     }
 
     std::vector<game> load_games()
@@ -48,21 +50,15 @@ namespace {
 
 size_t first_task()
 {
-    const std::map<std::string_view, size_t> available_quantities {
-        { "red", 12 },
-        { "green", 13 },
-        { "blue", 14 }
-    };
+    constexpr quantities available_quantities { 12, 13, 14 };
 
     const auto games = load_games();
 
     const auto is_valid_game = [&](const game& g) {
-        const auto is_valid_draw = [&](const draw& d) {
-            const auto it = available_quantities.find(d.color);
-            return it != available_quantities.end() && it->second >= d.quantity;
-        };
-
-        return std::ranges::all_of(g.draws | std::views::join, is_valid_draw);
+        return std::ranges::all_of(std::views::zip(g.max_quantities, available_quantities), [](const auto& drawn_and_available) {
+            const auto [drawn, available] = drawn_and_available;
+            return drawn <= available;
+        });
     };
 
     return std::ranges::fold_left(games | std::views::filter(is_valid_game) | std::views::transform(&game::id),
@@ -74,18 +70,8 @@ size_t second_task()
     const auto games = load_games();
 
     const auto power_per_game = games | std::views::transform([](const game& g) {
-        std::map<std::string_view, size_t> color_quantities;
-
-        for (const draw& d : g.draws | std::views::join) {
-            const auto it = color_quantities.find(d.color);
-            if (it != color_quantities.end()) {
-                it->second = std::max(it->second, d.quantity);
-            } else {
-                color_quantities.insert(it, { d.color, d.quantity });
-            }
-        }
-
-        return std::ranges::fold_left(color_quantities | std::views::values, size_t { 1 }, std::multiplies {});
+        return std::ranges::fold_left(g.max_quantities | std::views::filter([](const size_t q) { return q != 0; }), size_t { 1 },
+            std::multiplies {});
     });
 
     return std::ranges::fold_left(power_per_game, size_t { 0 }, std::plus {});
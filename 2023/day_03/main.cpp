@@ -1,212 +1,126 @@
 #include <util.hpp>
 
-#include <map>
-
-#include <mdspan> // works only with VS22 preview 17.9
-
 namespace aoc {
 namespace {
-    template <typename T>
-    struct arr2d {
-        arr2d() = default;
-
-        arr2d(const size_t rows, const size_t cols)
-            : storage(rows * cols)
-            , mdspan(storage.data(), rows, cols)
-        {
-        }
-
-        std::vector<T> storage;
-        std::mdspan<T, std::extents<size_t, std::dynamic_extent, std::dynamic_extent>> mdspan;
-    };
-
-    auto row_span(auto& arr, const ptrdiff_t row)
+    constexpr bool is_symbol(const char c)
     {
-        return std::span { &arr.mdspan[std::array<ptrdiff_t, 2> { row, 0 }], arr.mdspan.extent(1) };
+        return c != '.' && !is_digit(c);
     }
 
-    auto index_view(auto& arr)
+    // value of the run of digits that covers col
+    constexpr size_t number_at(const std::string_view row, size_t col)
     {
-        return std::views::cartesian_product( //
-            std::views::iota(ptrdiff_t { 0 }, static_cast<ptrdiff_t>(arr.mdspan.extent(0))), //
-            std::views::iota(ptrdiff_t { 0 }, static_cast<ptrdiff_t>(arr.mdspan.extent(1))));
-    }
+        while (col > 0 && is_digit(row[col - 1]))
+            --col;
 
-    auto neighbor_indices_view(const ptrdiff_t size)
-    {
-        return std::views::cartesian_product( //
-            std::views::iota(-size / 2, size / 2 + 1), //
-            std::views::iota(-size / 2, size / 2 + 1));
+        size_t value = 0;
+        for (; col < row.size() && is_digit(row[col]); ++col)
+            value = value * 10 + static_cast<size_t>(row[col] - '0');
+
+        return value;
     }
 
-    enum class field {
-        empty,
-        digit,
-        sign
+    struct schematic_sums {
+        size_t part_numbers = 0;
+        size_t gear_ratios = 0;
     };
 
-    field classify(const char c)
+    // evaluates the numbers and gears of row, everything adjacent to them is contained in the rows above and below
+    constexpr schematic_sums scan_row(const std::string_view above, const std::string_view row, const std::string_view below)
     {
-        if (c == '.')
-            return field::empty;
-        if (is_digit(c))
-            return field::digit;
-
-        return field::sign;
-    }
-
-    arr2d<char> read_input()
-    {
-        auto lines = load_input_by_line();
-        const auto height = std::ranges::distance(lines.begin(), lines.end());
-        const auto width = std::ranges::size(lines.front());
-
-        arr2d<char> map { static_cast<size_t>(height), static_cast<size_t>(width) };
-
-        for (const auto [idx, line] : std::views::enumerate(lines))
-            std::ranges::copy(line, row_span(map, idx).begin());
+        const std::array window { above, row, below };
+        schematic_sums sums;
+
+        const auto any_symbol = [&](const size_t first, const size_t last) {
+            return std::ranges::any_of(window, [=](const std::string_view r) {
+                return !r.empty() && std::ranges::any_of(r.substr(first, last - first + 1), is_symbol);
+            });
+        };
+
+        for (size_t col = 0; col < row.size(); ++col) {
+            if (is_digit(row[col])) {
+                const auto first = col;
+                while (col + 1 < row.size() && is_digit(row[col + 1]))
+                    ++col;
+
+                if (any_symbol(first == 0 ? 0 : first - 1, std::min(col + 1, row.size() - 1)))
+                    sums.part_numbers += number_at(row, first);
+            } else if (row[col] == '*') {
+                const auto first = col == 0 ? 0 : col - 1;
+                const auto last = std::min(col + 1, row.size() - 1);
+
+                std::array<size_t, 2> factors {};
+                size_t num_factors = 0;
+
+                for (const std::string_view r : window | std::views::filter(std::not_fn(&std::string_view::empty))) {
+                    for (size_t x = first; x <= last; ++x) {
+                        if (!is_digit(r[x]) || (x != first && is_digit(r[x - 1])))
+                            continue;
+
+                        if (num_factors < factors.size())
+                            factors[num_factors] = number_at(r, x);
+                        ++num_factors;
+                    }
+                }
+
+                if (num_factors == 2)
+                    sums.gear_ratios += factors[0] * factors[1];
+            }
+        }
 
-        return map;
+        return sums;
     }
 
-    arr2d<field> classify_map(const arr2d<char>& map)
+    // single pass over the schematic which only ever looks at a window of three rows
+    constexpr schematic_sums scan_schematic(std::string_view input)
     {
-        arr2d<field> classified_map { map.mdspan.extent(0), map.mdspan.extent(1) };
-        std::ranges::transform(map.storage, classified_map.storage.begin(), &classify);
-        return classified_map;
-    }
+        std::array<std::string_view, 3> window {};
+        schematic_sums sums;
 
-    arr2d<char> make_dilated_mask(const size_t rows, const size_t cols, auto&& seed_pixels)
-    {
-        arr2d<char> mask { rows, cols };
+        const auto shift_in = [&](const std::string_view next) {
+            window = { window[1], window[2], next };
 
-        for (const auto [row, col] : seed_pixels) {
-            for (const auto [delta_row, delta_col] : neighbor_indices_view(3)) {
-                const auto offset_row = row + delta_row;
-                const auto offset_col = col + delta_col;
+            if (!window[1].empty()) {
+                const auto [part_numbers, gear_ratios] = scan_row(window[0], window[1], window[2]);
+                sums.part_numbers += part_numbers;
+                sums.gear_ratios += gear_ratios;
+            }
+        };
 
-                if (offset_row < 0 || offset_row >= rows || offset_col < 0 || offset_col >= cols)
-                    continue;
+        while (!input.empty()) {
+            const auto line = input.substr(0, input.find('\n'));
+            input.remove_prefix(std::min(line.size() + 1, input.size()));
 
-                mask.mdspan[std::array { offset_row, offset_col }] = 1;
-            }
+            if (!line.empty())
+                shift_in(line);
         }
 
-        return mask;
+        shift_in({});
+        return sums;
     }
+
+    constexpr std::string_view example = "467..114..\n"
+                                         "...*......\n"
+                                         "..35..633.\n"
+                                         "......#...\n"
+                                         "617*......\n"
+                                         ".....+.58.\n"
+                                         "..592.....\n"
+                                         "......755.\n"
+                                         "...$.*....\n"
+                                         ".664.598..\n";
+
+    static_assert(scan_schematic(example).part_numbers == 4361);
+    static_assert(scan_schematic(example).gear_ratios == 467835);
 }
 
 size_t first_task()
 {
-    const auto map = read_input();
-    const auto rows = map.mdspan.extent(0);
-    const auto cols = map.mdspan.extent(1);
-
-    const auto classified_map = classify_map(map);
-    const auto dilated_mask = make_dilated_mask(rows, cols, index_view(classified_map) | std::views::filter([&](const auto indices) {
-        const auto [row, col] = indices;
-        return classified_map.mdspan[std::array { row,
-                   col }]
-            == field::sign;
-    }));
-
-    size_t sum = 0;
-
-    for (const auto row_idx : std::views::iota(ptrdiff_t { 0 }, static_cast<ptrdiff_t>(map.mdspan.extent(0)))) {
-        const auto classified_row = row_span(classified_map, row_idx);
-        const auto map_row = row_span(map, row_idx);
-
-        for (const auto& t : std::views::enumerate(classified_row) | std::views::chunk_by([](const auto first, const auto second) { return std::get<1>(first) == std::get<1>(second); })) {
-
-            if (std::get<1>(t.front()) != field::digit)
-                continue;
-
-            if (std::ranges::none_of(t | std::views::elements<0>, [=](const auto col_idx) {
-                    return dilated_mask.mdspan[std::array { row_idx, ptrdiff_t { col_idx } }] != 0;
-                }))
-                continue;
-
-            const std::span data = map_row.subspan(std::get<0>(t.front()),
-                std::get<0>(t.back()) - std::get<0>(t.front()) + 1);
-            sum += std::stoul(std::string { data.begin(), data.end() });
-        }
-    }
-
-    return sum;
+    return scan_schematic(load_input()).part_numbers;
 }
 
 size_t second_task()
 {
-    const auto map = read_input();
-    const auto rows = map.mdspan.extent(0);
-    const auto cols = map.mdspan.extent(1);
-
-    const auto classified_map = classify_map(map);
-
-    using segment_id = uint16_t;
-    using part_value = uint16_t;
-
-    struct segment {
-        segment_id segment_id;
-        part_value value;
-    };
-
-    auto segmented_map = arr2d<segment> { rows, cols };
-
-    {
-        uint16_t cnt = 0;
-        for (const auto row_idx : std::views::iota(ptrdiff_t { 0 }, static_cast<ptrdiff_t>(map.mdspan.extent(0)))) {
-            const auto classified_row = row_span(classified_map, row_idx);
-            const auto map_row = row_span(map, row_idx);
-
-            for (const auto& t : std::views::enumerate(classified_row) | std::views::chunk_by([](const auto first, const auto second) {
-                     return std::get<1>(first) == std::get<1>(second);
-                 })) {
-
-                if (std::get<1>(t.front()) != field::digit)
-                    continue;
-
-                const auto label = ++cnt;
-
-                const std::span data = map_row.subspan(std::get<0>(t.front()),
-                    std::get<0>(t.back()) - std::get<0>(t.front()) + 1);
-                const auto value = std::stoul(std::string { data.begin(), data.end() });
-
-                for (const auto col_idx : t | std::views::keys)
-                    segmented_map.mdspan[std::array { row_idx,
-                        col_idx }]
-                        = { .segment_id = label, .value = static_cast<part_value>(value) };
-            }
-        }
-    }
-
-    auto gear_ratios = index_view(map) //
-        | std::views::transform([&](const auto idx) -> size_t {
-              const auto [row, col] = idx;
-
-              if (map.mdspan[std::array { row, col }] != '*')
-                  return 0;
-
-              std::map<segment_id, part_value> adjacent_labels;
-
-              for (const auto [delta_row, delta_col] : neighbor_indices_view(3)) {
-                  const auto offset_row = row + delta_row;
-                  const auto offset_col = col + delta_col;
-
-                  if (offset_row < 0 || offset_row >= map.mdspan.extent(0) || offset_col < 0 || offset_col >= map.mdspan.extent(1))
-                      continue;
-
-                  const auto segment = segmented_map.mdspan[std::array { offset_row, offset_col }];
-                  if (segment.segment_id != 0)
-                      adjacent_labels[segment.segment_id] = segment.value;
-              }
-
-              if (adjacent_labels.size() != 2)
-                  return 0;
-
-              return adjacent_labels.begin()->second * adjacent_labels.rbegin()->second;
-          });
-
-    return std::ranges::fold_left(gear_ratios, size_t { 0 }, std::plus {});
+    return scan_schematic(load_input()).gear_ratios;
+}
 }
-}
\ No newline at end of file
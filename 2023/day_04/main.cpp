@@ -1,47 +1,75 @@
 #include <util.hpp>
 
-#include <set>
+#include <bit>
+#include <stdexcept>
+#include <utility>
 
 namespace aoc {
 namespace {
+    // card numbers are below 128, bit n of the mask is set if n is part of the set
+    struct number_set {
+        std::array<uint64_t, 2> bits {};
+
+        constexpr void insert(const size_t n)
+        {
+            if (n >= bits.size() * 64)
+                throw std::invalid_argument("card number out of range");
+
+            bits[n / 64] |= uint64_t { 1 } << (n % 64);
+        }
+
+        constexpr size_t intersection_size(const number_set& other) const
+        {
+            return std::popcount(bits[0] & other.bits[0]) + std::popcount(bits[1] & other.bits[1]);
+        }
+    };
+
+    constexpr size_t max_num_winnings = 128;
+
     struct card {
-        size_t id = 0;
-        size_t quantity = 1;
-        std::array<size_t, 10> winning_numbers {};
-        std::array<size_t, 25> our_numbers {};
+        number_set winning_numbers;
+        number_set our_numbers;
     };
 
-    card card_from_line(const std::string_view line)
+    constexpr card card_from_line(const std::string_view line)
     {
-        const std::vector numbers {
-            std::from_range, std::views::chunk_by(line, [](const auto a, const auto b) {
-                return is_digit(a) == is_digit(b);
-            }) //
-                | std::views::filter([](const auto range) {
-                      return is_digit(range.front());
-                  }) //
-                | std::views::transform([](const auto r) {
-                      return std::stoul(std::string { r.begin(), r.end() });
-                  })
-        };
-
-        card c { .id = numbers.front() };
-        std::ranges::copy(numbers | std::views::drop(1) | std::views::take(10), c.winning_numbers.begin());
-        std::ranges::copy(numbers | std::views::drop(11), c.our_numbers.begin());
+        card c;
+        number_set* current = &c.winning_numbers;
+
+        size_t number = 0;
+        bool in_number = false;
+
+        for (const char ch : line.substr(line.find(':') + 1)) {
+            if (is_digit(ch)) {
+                number = number * 10 + static_cast<size_t>(ch - '0');
+                in_number = true;
+                continue;
+            }
+
+            if (in_number)
+                current->insert(number);
+
+            number = 0;
+            in_number = false;
+
+            if (ch == '|')
+                current = &c.our_numbers;
+        }
+
+        if (in_number)
+            current->insert(number);
+
         return c;
     }
 
-    size_t num_winnings_cards(const card& c)
+    constexpr size_t num_winnings_cards(const card& c)
     {
-        const std::set<size_t> a(std::from_range, c.winning_numbers);
-        const std::set<size_t> b(std::from_range, c.our_numbers);
-
-        std::vector<size_t> intersection;
-        std::ranges::set_intersection(a, b, std::back_inserter(intersection));
-
-        return intersection.size();
+        return c.winning_numbers.intersection_size(c.our_numbers);
     }
 
+    static_assert(num_winnings_cards(card_from_line("Card 1: 41 48 83 86 17 | 83 86  6 31 17  9 48 53")) == 4);
+    static_assert(num_winnings_cards(card_from_line("Card 6: 31 18 13 56 72 | 74 77 10 23 35 67 36 11")) == 0);
+
     size_t calculate_points(const std::string_view line)
     {
         const auto winning_cards = num_winnings_cards(card_from_line(line));
@@ -58,15 +86,20 @@ size_t first_task()
 
 size_t second_task()
 {
-    std::vector cards { std::from_range, load_input_by_line() | std::views::transform(&card_from_line) };
+    // a card can only win copies of the next max_num_winnings cards, so the pending copies fit into a ring buffer
+    std::array<size_t, max_num_winnings + 1> extra_copies {};
+    size_t total = 0;
 
-    for (const auto&& [idx, card] : cards | std::views::enumerate) {
-        const auto num_win = num_winnings_cards(card);
+    for (const auto&& [idx, line] : load_input_by_line() | std::views::enumerate) {
+        const auto slot = static_cast<size_t>(idx);
+        const auto quantity = 1 + std::exchange(extra_copies[slot % extra_copies.size()], 0);
+        total += quantity;
 
-        for (auto& next : std::span { cards }.subspan(idx + 1, num_win))
-            next.quantity += card.quantity;
+        const auto num_win = num_winnings_cards(card_from_line(line));
+        for (size_t i = 1; i <= num_win; ++i)
+            extra_copies[(slot + i) % extra_copies.size()] += quantity;
     }
 
-    return std::ranges::fold_left(cards | std::views::transform(&card::quantity), size_t { 0 }, std::plus {});
+    return total;
 }
 }
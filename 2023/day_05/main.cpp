@@ -1,15 +1,28 @@
+#include <parse.hpp>
 #include <util.hpp>
 
 #include <map>
-#include <regex>
-#include <spanstream>
 
 namespace aoc {
 namespace {
+    enum class category {
+        seed,
+        soil,
+        fertilizer,
+        water,
+        light,
+        temperature,
+        humidity,
+        location
+    };
+
+    constexpr auto category_parser = parse::keywords<category>(std::to_array<std::string_view>({
+        "seed", "soil", "fertilizer", "water", "light", "temperature", "humidity", "location" }));
+
     struct almanac {
         struct mapping {
-            std::string from;
-            std::string to;
+            category from {};
+            category to {};
 
             struct range {
                 size_t start {};
@@ -61,23 +74,20 @@ namespace {
 
         almanac result;
 
-        result.seeds = { std::from_range,
-            lines.front()
-                | std::views::chunk_by([](const auto lhs, const auto rhs) {
-                      return is_digit(lhs) == is_digit(rhs);
-                  }) //
-                | std::views::filter([](const auto& t) { return is_digit(t.front()); }) //
-                | std::views::transform(
-                    [](const auto& t) { return std::stoul(std::string { t.begin(), t.end() }); }) };
+        const auto seeds_parser = parse::seq("seeds: ",
+            parse::fold_separated(parse::unsigned_number<>, " ", std::vector<size_t> {}, [](std::vector<size_t> seeds, const size_t seed) {
+                seeds.push_back(seed);
+                return seeds;
+            }));
+
+        result.seeds = std::get<0>(parse::parse_line(seeds_parser, lines.front()));
 
         const std::vector mapping_descriptors {
             std::from_range,
             lines
-                | std::views::drop(2)
-                | std::views::chunk_by([](const auto lhs, const auto rhs) { return !lhs.empty(); })
-                | std::views::transform([](const auto t) {
-                      return std::vector { std::from_range, t | std::views::take(std::ranges::size(t) - 1) };
-                  })
+                | std::views::drop(1)
+                | std::views::chunk_by([](const auto, const auto rhs) { return !rhs.ends_with(" map:"); })
+                | std::views::transform([](const auto t) { return std::vector { std::from_range, t }; })
         };
 
         result.mappings = { std::from_range,
@@ -85,23 +95,14 @@ namespace {
                 | std::views::transform([](const auto& lines) -> almanac::mapping {
                       almanac::mapping result;
 
-                      {
-                          const std::regex game_regex { R"(([a-z]+)-to-([a-z]+) map:)" };
-                          const std::string first_line { lines.front() };
-                          const std::sregex_iterator it { first_line.begin(), first_line.end(), game_regex };
+                      constexpr auto header_parser = parse::seq(category_parser, "-to-", category_parser, " map:");
+                      constexpr auto range_parser = parse::seq(parse::unsigned_number<>, " ", parse::unsigned_number<>, " ", parse::unsigned_number<>);
 
-                          result.from = it->str(1);
-                          result.to = it->str(2);
-                      }
+                      std::tie(result.from, result.to) = parse::parse_line(header_parser, lines.front());
 
                       for (const auto& line : lines | std::views::drop(1)) {
-
-                          almanac::mapping::range source_range;
-                          size_t destination_start;
-
-                          std::ispanstream { line } >> destination_start >> source_range.start
-                              >> source_range.len;
-                          result.source_to_dest.insert({ source_range, destination_start });
+                          const auto [destination_start, source_start, len] = parse::parse_line(range_parser, line);
+                          result.source_to_dest.insert({ { .start = source_start, .len = len }, destination_start });
                       }
 
                       return result;
@@ -1,75 +1,343 @@
+#include <parse.hpp>
 #include <util.hpp>
 
-#include <cassert>
-#include <map>
-#include <numeric>
+#include <bit>
+#include <execution>
+#include <limits>
+#include <optional>
 
 namespace aoc {
 namespace {
     using node_name = std::array<char, 3>;
+    using node_index = uint16_t;
 
-    struct junction {
-        node_name left {};
-        node_name right {};
-    };
+    // node names consist of three upper case letters or digits, a base-36 encoding maps them to dense indices
+    constexpr size_t num_node_indices = 36 * 36 * 36;
+
+    constexpr node_index to_index(const node_name& name)
+    {
+        return std::ranges::fold_left(name, node_index { 0 }, [](const node_index acc, const char c) {
+            if (is_digit(c))
+                return static_cast<node_index>(acc * 36 + (c - '0'));
+            if (c >= 'A' && c <= 'Z')
+                return static_cast<node_index>(acc * 36 + 10 + (c - 'A'));
+
+            throw std::invalid_argument("node names must consist of upper case letters and digits");
+        });
+    }
+
+    constexpr node_name to_name(node_index idx)
+    {
+        node_name name {};
+        for (char& c : name | std::views::reverse) {
+            const auto digit = idx % 36;
+            c = static_cast<char>(digit < 10 ? '0' + digit : 'A' + (digit - 10));
+            idx /= 36;
+        }
+        return name;
+    }
 
-    struct hasher {
-        size_t operator()(const node_name& name) const
+    static_assert(to_index({ '0', '0', '0' }) == 0);
+    static_assert(to_index({ 'Z', 'Z', 'Z' }) == num_node_indices - 1);
+    static_assert(to_name(to_index({ 'B', 'Q', 'Z' })) == node_name { 'B', 'Q', 'Z' });
+    static_assert(to_name(to_index({ '1', '1', 'A' })) == node_name { '1', '1', 'A' });
+
+    struct network {
+        std::string pattern;
+        std::vector<node_index> nodes;
+        std::vector<node_index> left = std::vector<node_index>(num_node_indices);
+        std::vector<node_index> right = std::vector<node_index>(num_node_indices);
+
+        [[nodiscard]] node_index step(const node_index node, const char dir) const
         {
-            return std::hash<std::string_view> {}({ name.begin(), name.end() });
+            return dir == 'L' ? left[node] : right[node];
         }
     };
 
-    auto read_input()
+    network read_input()
     {
         auto lines = load_input_by_line();
 
-        const std::string pattern { lines.front() };
+        network net { .pattern = std::string { lines.front() } };
 
-        constexpr auto parse = [](std::string_view line) -> std::pair<node_name, junction> {
-            node_name node;
-            node_name left;
-            node_name right;
+        constexpr auto node_parser = parse::transform(parse::identifier {}, [](const std::string_view name) {
+            node_name n {};
+            if (name.size() != n.size())
+                throw std::invalid_argument("node names must have three characters");
 
-            std::ranges::copy(line.substr(0, 3), node.begin());
-            std::ranges::copy(line.substr(7, 3), left.begin());
-            std::ranges::copy(line.substr(12, 3), right.begin());
+            std::ranges::copy(name, n.begin());
+            return to_index(n);
+        });
+        constexpr auto junction_parser = parse::seq(node_parser, " = (", node_parser, ", ", node_parser, ")");
 
-            return { node, { left, right } };
-        };
+        for (const std::string_view line : lines | std::views::drop(1)) {
+            const auto [node, left, right] = parse::parse_line(junction_parser, line);
+            net.nodes.push_back(node);
+            net.left[node] = left;
+            net.right[node] = right;
+        }
 
-        return std::pair { pattern, std::map<node_name, junction> { std::from_range, lines | std::views::drop(2) | std::views::transform(parse) } };
+        return net;
     }
 
-    size_t
-    calculate_num_steps_required(const auto& pattern, const auto& map, const node_name& from,
-        const auto& reached_end)
+    // per node summary of walking the whole pattern once, so that the pattern period can be skipped in a single hop
+    struct pattern_table {
+        static constexpr auto no_hit = std::numeric_limits<uint32_t>::max();
+
+        pattern_table(const network& net, const auto& reached_end)
+            : period_(net.pattern.size())
+            , is_end_(num_node_indices)
+            , first_hit_(num_node_indices, no_hit)
+        {
+            for (const node_index node : net.nodes)
+                is_end_[node] = reached_end(to_name(node));
+
+            std::vector<node_index>& after_pattern = jumps_.emplace_back(num_node_indices);
+
+            for (const node_index node : net.nodes) {
+                node_index current = node;
+
+                for (const auto [step, dir] : net.pattern | std::views::enumerate) {
+                    current = net.step(current, dir);
+
+                    if (first_hit_[node] == no_hit && is_end_[current])
+                        first_hit_[node] = static_cast<uint32_t>(step + 1);
+                }
+
+                after_pattern[node] = current;
+            }
+
+            // binary lifting: jumps_[k][n] is the node reached from n after 2^k full patterns; any cycle of
+            // pattern-aligned states is entered and closed within net.nodes.size() patterns
+            const auto num_levels = std::max<size_t>(std::bit_width(net.nodes.size()), 1);
+            while (jumps_.size() < num_levels) {
+                const std::vector<node_index>& prev = jumps_.back();
+                std::vector<node_index> next(num_node_indices);
+
+                for (const node_index node : net.nodes)
+                    next[node] = prev[prev[node]];
+
+                jumps_.push_back(std::move(next));
+            }
+        }
+
+        [[nodiscard]] size_t period() const
+        {
+            return period_;
+        }
+
+        [[nodiscard]] bool is_end(const node_index node) const
+        {
+            return is_end_[node];
+        }
+
+        // number of steps (1..period) into the pattern at which an end node is reached first when starting at node
+        [[nodiscard]] uint32_t first_hit(const node_index node) const
+        {
+            return first_hit_[node];
+        }
+
+        [[nodiscard]] node_index after_pattern(const node_index node) const
+        {
+            return jumps_.front()[node];
+        }
+
+        [[nodiscard]] node_index advance(node_index node, size_t num_patterns) const
+        {
+            for (size_t level = 0; level < jumps_.size() && num_patterns != 0; ++level, num_patterns >>= 1) {
+                if (num_patterns & 1)
+                    node = jumps_[level][node];
+            }
+
+            // remaining bits exceed the precomputed levels, each of them is worth two of the largest jumps
+            for (; num_patterns != 0; --num_patterns)
+                node = jumps_.back()[jumps_.back()[node]];
+
+            return node;
+        }
+
+    private:
+        size_t period_;
+        std::vector<bool> is_end_;
+        std::vector<uint32_t> first_hit_;
+        std::vector<std::vector<node_index>> jumps_;
+    };
+
+    size_t calculate_num_steps_required(const pattern_table& table, const size_t num_nodes, const node_index from)
     {
-        node_name current_node = from;
+        node_index current_node = from;
         size_t num_steps = 0;
 
-        for (auto dir : std::views::repeat(pattern) | std::views::join) {
-            const auto [left, right] = map.at(current_node);
-            current_node = dir == 'L' ? left : right;
-            ++num_steps;
+        // if no end node has been hit after visiting every node at the start of the pattern, it never will be
+        for (size_t i = 0; i <= num_nodes; ++i) {
+            if (const auto hit = table.first_hit(current_node); hit != pattern_table::no_hit)
+                return num_steps + hit;
 
-            if (reached_end(current_node))
-                return num_steps;
+            current_node = table.after_pattern(current_node);
+            num_steps += table.period();
         }
 
-        std::unreachable();
+        throw std::invalid_argument("end node is not reachable");
     }
 
-    size_t calculate_least_common_multiple(const std::span<const size_t> nums)
+    // the walk of a single ghost on the state space (node, pattern position): after offset steps the ghost enters a
+    // cycle of length steps, hits holds all steps in [1, offset + length] at which an end node is reached
+    struct ghost_cycle {
+        size_t offset = 0;
+        size_t length = 0;
+        std::vector<size_t> hits;
+
+        [[nodiscard]] bool is_end_at(const size_t step) const
+        {
+            const auto reduced = step <= offset ? step : offset + 1 + (step - offset - 1) % length;
+            return std::ranges::binary_search(hits, reduced);
+        }
+    };
+
+    ghost_cycle analyse_cycle(const network& net, const pattern_table& table, const node_index from)
+    {
+        // the state repeats iff the node at the start of the pattern repeats, so Brent's algorithm runs on
+        // the pattern-aligned sequence only
+        size_t power = 1;
+        size_t lambda = 1;
+        node_index tortoise = from;
+        node_index hare = table.after_pattern(from);
+
+        while (tortoise != hare) {
+            if (power == lambda) {
+                tortoise = hare;
+                power *= 2;
+                lambda = 0;
+            }
+            hare = table.after_pattern(hare);
+            ++lambda;
+        }
+
+        size_t mu = 0;
+        tortoise = from;
+        hare = table.advance(from, lambda);
+
+        while (tortoise != hare) {
+            tortoise = table.after_pattern(tortoise);
+            hare = table.after_pattern(hare);
+            ++mu;
+        }
+
+        ghost_cycle cycle { .offset = mu * table.period(), .length = lambda * table.period() };
+
+        node_index current = from;
+        for (size_t step = 1; step <= cycle.offset + cycle.length; ++step) {
+            current = net.step(current, net.pattern[(step - 1) % table.period()]);
+            if (table.is_end(current))
+                cycle.hits.push_back(step);
+        }
+
+        return cycle;
+    }
+
+    // x = residue (mod modulus)
+    struct congruence {
+        int64_t residue = 0;
+        int64_t modulus = 1;
+
+        friend bool operator==(const congruence&, const congruence&) = default;
+        friend auto operator<=>(const congruence&, const congruence&) = default;
+    };
+
+    constexpr std::array<int64_t, 3> extended_gcd(const int64_t a, const int64_t b)
+    {
+        if (b == 0)
+            return { a, 1, 0 };
+
+        const auto [g, x, y] = extended_gcd(b, a % b);
+        return { g, y, x - (a / b) * y };
+    }
+
+    static_assert(extended_gcd(240, 46)[0] == 2);
+    static_assert(240 * extended_gcd(240, 46)[1] + 46 * extended_gcd(240, 46)[2] == 2);
+
+    // generalized chinese remainder theorem, the moduli need not be coprime
+    constexpr std::optional<congruence> combine(const congruence& a, const congruence& b)
     {
-        std::vector<size_t> current_values { std::from_range, nums };
-        std::ranges::sort(current_values);
-
-        return std::ranges::fold_left_first(current_values | std::views::reverse,
-            [](const size_t lhs, const size_t rhs) {
-                return std::lcm(lhs, rhs);
-            })
-            .value();
+        const auto [g, p, q] = extended_gcd(a.modulus, b.modulus);
+        const auto diff = b.residue - a.residue;
+
+        if (diff % g != 0)
+            return std::nullopt;
+
+        // solve a.modulus * k = diff (mod b.modulus); all factors are reduced below b.modulus / g which
+        // keeps the product within 64 bit for the cycle lengths of a single ghost
+        const auto reduced_modulus = b.modulus / g;
+        const auto inverse = ((p % reduced_modulus) + reduced_modulus) % reduced_modulus;
+        const auto reduced_diff = ((diff / g % reduced_modulus) + reduced_modulus) % reduced_modulus;
+        const auto k = reduced_diff * inverse % reduced_modulus;
+
+        const auto modulus = a.modulus * reduced_modulus;
+        return congruence { .residue = (a.residue + a.modulus * k) % modulus, .modulus = modulus };
+    }
+
+    static_assert(combine({ 2, 3 }, { 3, 5 }) == congruence { 8, 15 });
+    static_assert(combine({ 2, 4 }, { 4, 6 }) == congruence { 10, 12 });
+    static_assert(!combine({ 1, 4 }, { 2, 6 }));
+
+    std::optional<size_t> first_common_hit(const std::span<const ghost_cycle> cycles)
+    {
+        if (cycles.empty())
+            return std::nullopt;
+
+        const auto latest = std::ranges::max_element(cycles, {}, &ghost_cycle::offset);
+        const auto all_end_at = [&](const size_t step) {
+            return std::ranges::all_of(cycles, [=](const ghost_cycle& cycle) { return cycle.is_end_at(step); });
+        };
+
+        // before every ghost has entered its cycle, only the finitely many hits of the latest one are candidates
+        for (const size_t step : latest->hits | std::views::take_while([&](const size_t s) { return s <= latest->offset; })) {
+            if (all_end_at(step))
+                return step;
+        }
+
+        // afterwards each ghost contributes one congruence per hit within its cycle
+        const auto cyclic_congruences = [](const ghost_cycle& cycle) {
+            return cycle.hits
+                | std::views::filter([&](const size_t step) { return step > cycle.offset; })
+                | std::views::transform([&](const size_t step) {
+                      return congruence { .residue = static_cast<int64_t>(step % cycle.length), .modulus = static_cast<int64_t>(cycle.length) };
+                  });
+        };
+
+        // All solutions combined so far share one modulus, the lcm of the cycle lengths seen so far, so after removing
+        // duplicates there are never more of them than that modulus. Up to that bound the list grows with the product
+        // of the hit counts per cycle, which is exponential in the number of ghosts if several ghosts pass multiple end
+        // nodes per cycle. To keep it small the ghosts with the fewest hits are combined first, and the search stops
+        // as soon as no solution is left.
+        std::vector<const ghost_cycle*> by_num_hits { std::from_range, cycles | std::views::transform([](const ghost_cycle& c) { return &c; }) };
+        std::ranges::sort(by_num_hits, {}, [&](const ghost_cycle* c) { return std::ranges::distance(cyclic_congruences(*c)); });
+
+        std::vector<congruence> solutions { congruence {} };
+
+        for (const ghost_cycle* cycle : by_num_hits) {
+            std::vector<congruence> next;
+
+            for (const auto& [lhs, rhs] : std::views::cartesian_product(solutions, cyclic_congruences(*cycle))) {
+                if (const auto c = combine(lhs, rhs))
+                    next.push_back(*c);
+            }
+
+            std::ranges::sort(next);
+            const auto [first, last] = std::ranges::unique(next);
+            next.erase(first, last);
+
+            solutions = std::move(next);
+
+            if (solutions.empty())
+                return std::nullopt;
+        }
+
+        const auto min_step = static_cast<int64_t>(latest->offset) + 1;
+        return std::ranges::min(solutions | std::views::transform([=](const congruence& c) {
+            const auto num_periods = c.residue >= min_step ? 0 : (min_step - c.residue + c.modulus - 1) / c.modulus;
+            return static_cast<size_t>(c.residue + num_periods * c.modulus);
+        }));
     }
 }
 
@@ -78,30 +346,32 @@ size_t first_task()
     static constexpr node_name start_node { 'A', 'A', 'A' };
     static constexpr node_name end_node { 'Z', 'Z', 'Z' };
 
-    const auto [pattern, map] = read_input();
-    return calculate_num_steps_required(pattern, map, start_node, std::bind_front(std::equal_to {}, end_node));
+    const auto net = read_input();
+    const pattern_table table { net, std::bind_front(std::equal_to {}, end_node) };
+
+    return calculate_num_steps_required(table, net.nodes.size(), to_index(start_node));
 }
 
 size_t second_task()
 {
-    const auto [pattern, map] = read_input();
+    const auto net = read_input();
 
     constexpr auto is_start_node = [](const node_name& name) { return name[2] == 'A'; };
     constexpr auto is_end_node = [](const node_name& name) { return name[2] == 'Z'; };
 
-    const std::vector<node_name> start_nodes { std::from_range,
-        map | std::views::keys | std::views::filter(is_start_node) };
+    const pattern_table table { net, is_end_node };
+
+    const std::vector<node_index> start_nodes { std::from_range,
+        net.nodes | std::views::filter([&](const node_index node) { return is_start_node(to_name(node)); }) };
 
-    const std::vector<size_t> cycle_lengths { std::from_range,
-        start_nodes | std::views::transform([&](const node_name& node) {
-            const auto num_steps = calculate_num_steps_required(pattern,
-                map,
-                node,
-                is_end_node);
-            assert(num_steps % pattern.size() == 0);
-            return num_steps / pattern.size();
-        }) };
+    std::vector<ghost_cycle> cycles(start_nodes.size());
+    std::transform(std::execution::par, start_nodes.begin(), start_nodes.end(), cycles.begin(),
+        [&](const node_index node) { return analyse_cycle(net, table, node); });
 
-    return calculate_least_common_multiple(cycle_lengths) * pattern.size();
+    const auto num_steps = first_common_hit(cycles);
+    if (!num_steps)
+        throw std::invalid_argument("ghosts never reach end nodes simultaneously");
+
+    return *num_steps;
+}
 }
-}
\ No newline at end of file
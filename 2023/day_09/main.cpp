@@ -1,72 +1,113 @@
 #include <util.hpp>
 
-#include <spanstream>
+#include <map>
 
 namespace aoc {
 namespace {
+    // number of sequences of the same length that are extrapolated side by side
+    constexpr size_t batch_width = 8;
+
+    // sequences of equal length, stored in batches of batch_width lanes: values[(batch * length + i) * batch_width + lane]
+    // is the i-th element of sequence batch * batch_width + lane, unused lanes stay zero
+    struct sequence_batches {
+        size_t length = 0;
+        size_t num_sequences = 0;
+        std::vector<uint64_t> values;
+
+        std::span<uint64_t> append()
+        {
+            const auto lane = num_sequences++ % batch_width;
+            if (lane == 0)
+                values.resize(values.size() + length * batch_width);
+
+            return std::span { values }.last(length * batch_width).subspan(lane);
+        }
+    };
+
     auto get_input()
     {
-        const auto process_line = [](const std::string_view line) {
-            std::vector<ptrdiff_t> numbers;
+        std::map<size_t, sequence_batches> sequences_by_length;
 
-            std::ispanstream iss { line };
-            std::ranges::copy(std::istream_iterator<ptrdiff_t> { iss }, std::istream_iterator<ptrdiff_t> {},
-                std::back_inserter(numbers));
+        for (const std::string_view line : load_input_by_line()) {
+            auto numbers = line | std::views::split(' ') | std::views::transform(as_string_view)
+                | std::views::filter(std::not_fn(&std::string_view::empty));
 
-            return numbers;
-        };
+            const auto length = static_cast<size_t>(std::ranges::distance(numbers));
+            auto& batches = sequences_by_length[length];
+            batches.length = length;
 
-        return load_input_by_line() | std::views::transform(process_line);
-    }
+            const auto lane = batches.append();
+            for (const auto [i, number] : numbers | std::views::enumerate)
+                lane[i * batch_width] = static_cast<uint64_t>(to_int<int64_t>(number));
+        }
 
-    struct add_last {
-    };
+        return sequences_by_length;
+    }
 
-    struct subtract_from_first {
+    struct extrapolation {
+        int64_t next = 0;
+        int64_t previous = 0;
     };
 
-    template <typename Op>
-    auto solve(const std::span<const ptrdiff_t> numbers)
+    // The difference triangle of n values extrapolates the unique polynomial of degree < n through them, so the
+    // extrapolated values are binomial-weighted sums of the inputs:
+    //   a[n]  = sum_i (-1)^(n-1-i) C(n, i)   a[i]
+    //   a[-1] = sum_i (-1)^i       C(n, i+1) a[i]
+    // Arithmetic is done modulo 2^64 which is exact as long as the result fits, even when the coefficients don't.
+    extrapolation extrapolate(const sequence_batches& batches)
     {
-        auto buf = numbers | std::ranges::to<std::vector>();
-        std::vector<ptrdiff_t> last_elements;
+        const auto n = batches.length;
+
+        std::vector<uint64_t> binomials(n + 1);
+        binomials[0] = 1;
+        for (size_t row = 1; row <= n; ++row) {
+            for (size_t k = row; k > 0; --k)
+                binomials[k] += binomials[k - 1];
+        }
 
-        constexpr auto make_adjacent_diff = std::views::adjacent_transform<2>(
-            [](const auto lhs, const auto rhs) { return rhs - lhs; });
+        const auto sign = [](const size_t exponent, const uint64_t v) { return exponent % 2 == 0 ? v : uint64_t { 0 } - v; };
 
-        while (!std::ranges::all_of(buf, std::bind_front(std::equal_to {}, ptrdiff_t { 0 }))) {
-            last_elements.push_back(std::same_as<Op, add_last> ? buf.back() : buf.front());
-            buf = buf | make_adjacent_diff | std::ranges::to<std::vector>();
+        std::vector<uint64_t> next_weights(n);
+        std::vector<uint64_t> previous_weights(n);
+        for (size_t i = 0; i < n; ++i) {
+            next_weights[i] = sign(n - 1 - i, binomials[i]);
+            previous_weights[i] = sign(i, binomials[i + 1]);
         }
 
-        size_t sum = 0;
+        std::array<uint64_t, batch_width> next {};
+        std::array<uint64_t, batch_width> previous {};
 
-        while (!last_elements.empty()) {
-            if constexpr (std::same_as<Op, add_last>)
-                sum = sum + last_elements.back();
-            else
-                sum = last_elements.back() - sum;
+        for (size_t offset = 0; offset < batches.values.size(); offset += n * batch_width) {
+            for (size_t i = 0; i < n; ++i) {
+                const auto* row = batches.values.data() + offset + i * batch_width;
 
-            last_elements.pop_back();
+                for (size_t lane = 0; lane < batch_width; ++lane) {
+                    next[lane] += next_weights[i] * row[lane];
+                    previous[lane] += previous_weights[i] * row[lane];
+                }
+            }
         }
 
-        return sum;
+        const auto sum = [](const auto& lanes) { return static_cast<int64_t>(std::ranges::fold_left(lanes, uint64_t { 0 }, std::plus {})); };
+        return { sum(next), sum(previous) };
     }
 
-    template <typename Op>
-    size_t solve_with_op()
+    extrapolation solve()
     {
-        return std::ranges::fold_left(get_input() | std::views::transform(&solve<Op>), ptrdiff_t { 0 }, std::plus {});
+        return std::ranges::fold_left(get_input() | std::views::values | std::views::transform(&extrapolate), extrapolation {},
+            [](const extrapolation& lhs, const extrapolation& rhs) {
+                return extrapolation { lhs.next + rhs.next, lhs.previous + rhs.previous };
+            });
     }
 }
 
 size_t first_task()
 {
-    return solve_with_op<add_last>();
+    return solve().next;
 }
 
 size_t second_task()
 {
-    return solve_with_op<subtract_from_first>();
+    return solve().previous;
 }
 }
@@ -1,8 +1,9 @@
 #include <aoc23/map.h>
 #include <util.hpp>
 
-#include <set>
-#include <stack>
+#include <bit>
+#include <cstdlib>
+#include <optional>
 #include <utility>
 
 namespace aoc {
@@ -39,82 +40,89 @@ namespace {
 
     using position = std::pair<ptrdiff_t, ptrdiff_t>;
 
-    constexpr std::vector<position> possible_neighbors(const field p)
-    {
-        switch (p) {
-        case field::none:
-            return {};
-        case field::NS:
-            return { { -1, 0 },
-                { 1, 0 } };
-        case field::WE:
-            return { { 0, -1 },
-                { 0, 1 } };
-        case field::NE:
-            return { { -1, 0 },
-                { 0, 1 } };
-        case field::NW:
-            return { { -1, 0 },
-                { 0, -1 } };
-        case field::SW:
-            return { { 1, 0 },
-                { 0, -1 } };
-        case field::SE:
-            return { { 1, 0 },
-                { 0, 1 } };
-        case field::start:
-            return { { 1, 0 },
-                { -1, 0 },
-                { 0, 1 },
-                { 0, -1 } };
-        }
+    // bit i of a connectivity mask is set if the tile connects to direction i (north, east, south, west)
+    using connectivity = uint8_t;
+
+    constexpr auto direction_offsets = std::to_array<position>({ { -1, 0 }, { 0, 1 }, { 1, 0 }, { 0, -1 } });
 
-        std::unreachable();
+    constexpr connectivity north = 1 << 0;
+    constexpr connectivity east = 1 << 1;
+    constexpr connectivity south = 1 << 2;
+    constexpr connectivity west = 1 << 3;
+
+    constexpr size_t opposite(const size_t direction)
+    {
+        return (direction + 2) % 4;
     }
 
-    std::vector<position>
-    find_loop_inner(const position current_pos, const position rel_origin, const map<field>& m,
-        std::set<position>& visited)
+    constexpr auto connectivity_table = std::to_array<connectivity>({
+        0, // none
+        north | south, // NS
+        west | east, // WE
+        north | east, // NE
+        north | west, // NW
+        south | west, // SW
+        south | east, // SE
+        north | east | south | west // start
+    });
+
+    constexpr connectivity connections(const field f)
     {
-        std::vector<std::vector<position>> found_paths_to_start;
+        return connectivity_table[std::to_underlying(f)];
+    }
 
-        const auto current_value = m[current_pos.first, current_pos.second];
+    struct pipe_loop {
+        size_t length = 0;
+        // shoelace sum over the tile centers along the loop, i.e. twice the signed enclosed area
+        int64_t twice_area = 0;
+    };
 
-        if (current_value == field::start)
-            found_paths_to_start.push_back({ current_pos });
+    std::optional<position> neighbor(const map<field>& m, const position p, const size_t direction)
+    {
+        const auto [d_r, d_c] = direction_offsets[direction];
+        const position offset_pos { p.first + d_r, p.second + d_c };
 
-        for (auto delta_pos : possible_neighbors(current_value)) {
+        if (offset_pos.first < 0 || offset_pos.first >= m.rows() || //
+            offset_pos.second < 0 || offset_pos.second >= m.cols())
+            return std::nullopt;
 
-            if (delta_pos == rel_origin)
-                continue;
+        return offset_pos;
+    }
 
-            const auto offset_pos = position { current_pos.first + delta_pos.first,
-                current_pos.second + delta_pos.second };
+    // follows the pipes leaving start in the given direction, every tile entered has to connect back to the tile it is
+    // entered from, nullopt if the walk gets stuck before it returns to start
+    std::optional<pipe_loop> walk_loop(const map<field>& m, const position start, const size_t first_direction)
+    {
+        pipe_loop l;
 
-            if (offset_pos.first < 0 || offset_pos.first >= m.rows() || //
-                offset_pos.second < 0 || offset_pos.second >= m.cols())
-                continue;
+        position current_pos = start;
+        size_t direction = first_direction;
 
-            if (visited.contains(offset_pos))
-                continue;
+        while (true) {
+            const auto next_pos = neighbor(m, current_pos, direction);
+            if (!next_pos)
+                return std::nullopt;
 
-            visited.insert(offset_pos);
+            const auto next_connections = connections(m[next_pos->first, next_pos->second]);
+            if (!(next_connections & (1 << opposite(direction))))
+                return std::nullopt;
 
-            auto path = find_loop_inner(offset_pos, { -delta_pos.first, -delta_pos.second }, m, visited);
+            l.twice_area += current_pos.second * next_pos->first - next_pos->second * current_pos.first;
+            ++l.length;
 
-            if (!path.empty()) {
-                path.insert(path.begin(), current_pos);
-                found_paths_to_start.push_back(std::move(path));
-            }
-        }
+            if (*next_pos == start)
+                return l;
 
-        if (found_paths_to_start.empty())
-            return {};
+            // a walk longer than the number of tiles can't be a loop through the start
+            if (l.length > m.rows() * m.cols())
+                return std::nullopt;
 
-        return std::ranges::max(found_paths_to_start, std::less {}, [](const auto& t) { return t.size(); });
+            current_pos = *next_pos;
+            direction = static_cast<size_t>(std::countr_zero(static_cast<connectivity>(next_connections & ~(1 << opposite(direction)))));
+        }
     }
 
-    auto find_loop(const map<field>& m)
+    pipe_loop find_loop(const map<field>& m)
     {
         auto indices = index_view(m);
 
@@ -123,105 +131,29 @@ namespace {
             return m[row, col] == field::start;
         });
 
-        std::set<std::pair<ptrdiff_t, ptrdiff_t>> visited;
-        return find_loop_inner({ start_row, start_col }, { 0, 0 }, m, visited);
-    }
-
-    map<field> scale_up(const map<field>& m)
-    {
-        map<field> up_scaled(m.rows() * 3, m.cols() * 3);
-        std::ranges::fill(up_scaled.data(), field::none);
-
-        for (const auto [r, c] : index_view(m)) {
-            const auto t = m[r, c];
-
-            if (t == field::none)
-                continue;
-
-            up_scaled[r * 3, c * 3] = field::start;
-            for (const auto [d_r, d_c] : possible_neighbors(t))
-                up_scaled[r * 3 + d_r, c * 3 + d_c] = field::start;
-        }
-
-        return up_scaled;
-    }
-
-    map<field> scale_down(const map<field>& m)
-    {
-        map<field> down_scaled(m.rows() / 3, m.cols() / 3);
-        std::ranges::fill(down_scaled.data(), field::none);
-
-        for (const auto [r, c] : index_view(down_scaled)) {
-            const auto t = m[r * 3, c * 3];
-
-            if (t == field::none)
-                continue;
-
-            down_scaled[r, c] = t;
+        // neighbors of the start may connect to it without being part of the loop, so each direction is tried until a
+        // walk closes back at the start
+        for (size_t direction = 0; direction < 4; ++direction) {
+            if (auto l = walk_loop(m, { start_row, start_col }, direction))
+                return std::move(*l);
         }
 
-        return down_scaled;
-    }
-
-    void flood_fill(const position start_pos, map<field>& m, const field fill_value = field::WE)
-    {
-        std::stack<position> stack;
-        stack.push(start_pos);
-
-        while (!stack.empty()) {
-            const auto pos = stack.top();
-            stack.pop();
-
-            if (m[pos.first, pos.second] != field::none)
-                continue;
-
-            m[pos.first, pos.second] = fill_value;
-
-            for (const auto delta_pos : std::to_array<position>({ { -1, 0 },
-                     { 1, 0 },
-                     { 0, -1 },
-                     { 0, 1 } })) {
-                const auto offset_pos = position { pos.first + delta_pos.first, pos.second + delta_pos.second };
-
-                if (offset_pos.first < 0 || offset_pos.first >= m.rows() || //
-                    offset_pos.second < 0 || offset_pos.second >= m.cols())
-                    continue;
-
-                if (m[offset_pos.first, offset_pos.second] != field::none)
-                    continue;
-
-                stack.push(offset_pos);
-            }
-        }
+        throw std::invalid_argument("loop is not closed");
     }
 }
 
 size_t first_task()
 {
     const auto map = get_input();
-    return (find_loop(map).size() - 2) / 2 + 1;
+    return find_loop(map).length / 2;
 }
 
 size_t second_task()
 {
-    const auto input_map = get_input();
-    auto masked_map = input_map;
-    const auto loop = find_loop(input_map);
+    const auto loop = find_loop(get_input());
 
-    std::ranges::fill(masked_map.data(), field::none);
-    for (const auto [r, c] : loop)
-        masked_map[r, c] = input_map[r, c];
-
-    masked_map[loop.front().first, loop.front().second] = field::SW;
-
-    map up_scaled = scale_up(masked_map);
-
-    flood_fill({ 0, 0 }, up_scaled);
-    flood_fill({ up_scaled.rows() - 1, 0 }, up_scaled);
-    flood_fill({ 0, up_scaled.cols() - 1 }, up_scaled);
-    flood_fill({ up_scaled.rows() - 1, up_scaled.cols() - 1 }, up_scaled);
-
-    const auto down_scaled = scale_down(up_scaled);
-    return std::ranges::count(down_scaled.data(), field::none);
+    // Pick's theorem: area = interior + boundary / 2 - 1, with every loop tile being a boundary point
+    const auto area_times_two = static_cast<size_t>(std::abs(loop.twice_area));
+    return (area_times_two - loop.length) / 2 + 1;
+}
 }
-}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <util.hpp>
 
-#include <unordered_map>
+#include <array>
+#include <execution>
+#include <numeric>
 
 namespace aoc {
 namespace {
@@ -20,19 +22,95 @@ namespace {
         return { to_int(first), to_int(second) };
     }
 
-    std::vector<std::pair<int32_t, int32_t>> get_numbers()
+    // LSD radix sort with 8 bit digits, the sign bit is flipped so negative values order before positive ones
+    void radix_sort(std::vector<int32_t>& values)
     {
-        return load_input_by_line() | std::views::transform(extract_ints) | std::ranges::to<std::vector>();
+        constexpr size_t radix_bits = 8;
+        constexpr size_t num_buckets = size_t { 1 } << radix_bits;
+
+        const auto key = [](const int32_t v) { return static_cast<uint32_t>(v) ^ 0x8000'0000u; };
+
+        std::vector<int32_t> scratch(values.size());
+
+        for (size_t shift = 0; shift < 32; shift += radix_bits) {
+            const auto digit = [&](const int32_t v) { return (key(v) >> shift) & (num_buckets - 1); };
+
+            std::array<size_t, num_buckets> offsets {};
+            for (const auto v : values)
+                ++offsets[digit(v)];
+
+            // all values share this digit, the pass would not move anything
+            if (std::ranges::contains(offsets, values.size()))
+                continue;
+
+            std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), size_t { 0 });
+
+            for (const auto v : values)
+                scratch[offsets[digit(v)]++] = v;
+
+            values.swap(scratch);
+        }
+    }
+
+    struct location_lists {
+        std::vector<int32_t> left;
+        std::vector<int32_t> right;
+    };
+
+    // both lists sorted ascending, the two columns are sorted concurrently
+    location_lists get_sorted_lists()
+    {
+        location_lists lists;
+
+        for (const auto [a, b] : load_input_by_line() | std::views::transform(extract_ints)) {
+            lists.left.push_back(a);
+            lists.right.push_back(b);
+        }
+
+        std::array columns { &lists.left, &lists.right };
+        std::for_each(std::execution::par, columns.begin(), columns.end(), [](std::vector<int32_t>* column) { radix_sort(*column); });
+
+        return lists;
+    }
+
+    // merge-join over the runs of equal values of both sorted lists
+    size_t similarity_score(const std::span<const int32_t> left, const std::span<const int32_t> right)
+    {
+        size_t score = 0;
+        size_t l = 0;
+        size_t r = 0;
+
+        while (l < left.size() && r < right.size()) {
+            if (left[l] < right[r]) {
+                ++l;
+                continue;
+            }
+
+            if (right[r] < left[l]) {
+                ++r;
+                continue;
+            }
+
+            const auto value = left[l];
+
+            size_t left_run = 0;
+            for (; l < left.size() && left[l] == value; ++l)
+                ++left_run;
+
+            size_t right_run = 0;
+            for (; r < right.size() && right[r] == value; ++r)
+                ++right_run;
+
+            score += static_cast<size_t>(value) * left_run * right_run;
+        }
+
+        return score;
     }
 }
 
 size_t first_task()
 {
-    const auto numbers = get_numbers();
-    auto first = numbers | std::views::keys | std::ranges::to<std::vector>();
-    std::ranges::sort(first);
-    auto second = numbers | std::views::values | std::ranges::to<std::vector>();
-    std::ranges::sort(second);
+    const auto [first, second] = get_sorted_lists();
 
     size_t diffs = 0;
     for (const auto [a, b] : std::views::zip(first, second))
@@ -43,18 +121,7 @@ size_t first_task()
 
 size_t second_task()
 {
-    const auto numbers = get_numbers();
-
-    std::unordered_map<int32_t, int32_t> histogram;
-
-    for (const auto t : numbers | std::views::values)
-        histogram[t]++;
-
-    size_t diff = 0;
-
-    for (const auto t : numbers | std::views::keys)
-        diff += t * histogram[t];
-
-    return diff;
+    const auto [first, second] = get_sorted_lists();
+    return similarity_score(first, second);
 }
 }
@@ -1,56 +1,118 @@
 #include <util.hpp>
 
-#include <cmath>
+#include <execution>
+#include <numeric>
 
 namespace aoc {
 namespace {
-    std::vector<int32_t> extract_ints(const std::string_view s)
-    {
-        return s | std::views::split(' ') | std::views::transform(as_string_view) | std::views::transform(&to_int<>) | std::ranges::to<std::vector>();
-    }
+    // all reports back to back in one buffer, report i spans the levels [offsets[i], offsets[i + 1])
+    class report_batch {
+    public:
+        void add(const std::string_view line)
+        {
+            for (const auto level : line | std::views::split(' ') | std::views::transform(as_string_view)) {
+                if (!level.empty())
+                    levels_.push_back(to_int<int32_t>(level));
+            }
+
+            offsets_.push_back(levels_.size());
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return offsets_.size() - 1;
+        }
 
-    std::vector<std::vector<int32_t>> get_reports()
+        [[nodiscard]] std::span<const int32_t> operator[](const size_t i) const
+        {
+            return std::span { levels_ }.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+        }
+
+    private:
+        std::vector<int32_t> levels_;
+        std::vector<size_t> offsets_ { 0 };
+    };
+
+    report_batch get_reports()
     {
-        return load_input_by_line() | std::views::transform(extract_ints) | std::ranges::to<std::vector>();
+        report_batch batch;
+        for (const auto line : load_input_by_line())
+            batch.add(line);
+
+        return batch;
     }
 
-    bool is_safe_impl(const std::span<const int32_t> report)
+    constexpr size_t no_skip = std::numeric_limits<size_t>::max();
+
+    // index of the first level that doesn't change by 1 to 3 in the given direction from its predecessor, ignoring
+    // the level at skip, or report.size() if there is none
+    constexpr size_t first_violation(const std::span<const int32_t> report, const int32_t direction, const size_t skip = no_skip)
     {
-        const auto diffs = report | std::views::adjacent_transform<2>(std::minus {});
+        size_t prev = no_skip;
+
+        for (size_t i = 0; i < report.size(); ++i) {
+            if (i == skip)
+                continue;
+
+            if (prev != no_skip) {
+                const auto step = (report[i] - report[prev]) * direction;
+                if (step < 1 || step > 3)
+                    return i;
+            }
 
-        if (const auto [min, max] = std::ranges::minmax(diffs); std::signbit(min) != std::signbit(max))
-            return false;
+            prev = i;
+        }
 
-        const auto [min, max] = std::ranges::minmax(
-            diffs | std::views::transform([](const auto t) { return std::abs(t); }));
+        return report.size();
+    }
 
-        return std::abs(min) >= 1 && std::abs(max) <= 3;
+    constexpr bool is_safe_impl(const std::span<const int32_t> report)
+    {
+        return first_violation(report, 1) == report.size() || first_violation(report, -1) == report.size();
     }
 
-    bool is_safe_with_dampener(const std::span<const int32_t> report)
+    // Any removal that makes the report safe has to remove one of the two levels of the first violating step, since
+    // that step stays otherwise. So per direction at most two more linear scans are needed.
+    constexpr bool is_safe_with_dampener(const std::span<const int32_t> report)
     {
-        if (is_safe_impl(report))
-            return true;
+        for (const int32_t direction : { 1, -1 }) {
+            const auto violation = first_violation(report, direction);
 
-        for (size_t i = 0; i < report.size(); ++i) {
-            auto t = report | std::ranges::to<std::vector>();
-            t.erase(std::next(t.begin(), i));
+            if (violation == report.size())
+                return true;
 
-            if (is_safe_impl(t))
+            if (first_violation(report, direction, violation) == report.size()
+                || first_violation(report, direction, violation - 1) == report.size())
                 return true;
         }
 
         return false;
     }
+
+    static_assert(is_safe_impl(std::to_array({ 7, 6, 4, 2, 1 })));
+    static_assert(!is_safe_impl(std::to_array({ 1, 3, 2, 4, 5 })));
+    static_assert(!is_safe_with_dampener(std::to_array({ 1, 2, 7, 8, 9 })));
+    static_assert(is_safe_with_dampener(std::to_array({ 1, 3, 2, 4, 5 })));
+    static_assert(is_safe_with_dampener(std::to_array({ 8, 6, 4, 4, 1 })));
+    static_assert(is_safe_with_dampener(std::to_array({ 9, 1, 2, 3, 4 })));
+
+    template <std::predicate<std::span<const int32_t>> Pred>
+    size_t count_reports(const report_batch& batch, Pred pred)
+    {
+        const auto indices = index_vector(batch.size());
+
+        return std::transform_reduce(std::execution::par, indices.begin(), indices.end(), size_t { 0 }, std::plus {},
+            [&](const size_t i) -> size_t { return pred(batch[i]); });
+    }
 }
 
 size_t first_task()
 {
-    return std::ranges::distance(get_reports() | std::views::filter(is_safe_impl));
+    return count_reports(get_reports(), is_safe_impl);
 }
 
 size_t second_task()
 {
-    return std::ranges::distance(get_reports() | std::views::filter(is_safe_with_dampener));
+    return count_reports(get_reports(), is_safe_with_dampener);
 }
 }
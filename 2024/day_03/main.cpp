@@ -1,119 +1,106 @@
+#include <static_regex.hpp>
 #include <util.hpp>
 
+#include <execution>
 #include <optional>
-#include <regex>
-#include <utility>
+#include <thread>
 
 namespace aoc {
 namespace {
-    enum class token_t {
-        mul,
-        do_it,
-        dont_do_it
+    using mul_regex = static_regex<R"(mul\((\d+),(\d+)\))">;
+
+    // The result of scanning a chunk without knowing whether multiplications are enabled at its start. Every
+    // instruction belongs to the chunk it starts in, matching may read beyond the end of the chunk.
+    struct chunk_summary {
+        size_t sum = 0;
+        // multiplications before the first do() or don't(), enabled if they are enabled at the start of the chunk
+        size_t sum_before_toggle = 0;
+        // enabled multiplications after the first do() or don't()
+        size_t sum_enabled = 0;
+        // whether multiplications are enabled after the last do() or don't(), empty if there is none
+        std::optional<bool> final_state;
     };
 
-    struct match {
-        token_t token;
-        size_t start;
-        size_t end;
-    };
-
-    std::optional<match> find_next(std::string_view s, const auto& tokens)
+    chunk_summary scan_chunk(const std::string_view input, const size_t begin, const size_t end)
     {
-        std::optional<match> min_found;
-
-        for (const auto [tok, str] : tokens) {
-            auto pos = s.find(str);
-
-            if (pos == std::string::npos)
-                continue;
-
-            if (!min_found || pos + str.length() < min_found->end)
-                min_found = { tok, pos, pos + str.length() };
-        }
-
-        return min_found;
-    }
-}
+        chunk_summary summary;
 
-size_t first_task()
-{
-    const std::regex r(R"(mul\((\d+),(\d+)\))");
-
-    size_t sum = 0;
+        // only positions of 'm' and 'd' can start an instruction, everything in between is skipped with find
+        size_t next_m = input.find('m', begin);
+        size_t next_d = input.find('d', begin);
 
-    for (auto t : load_input_by_line()) {
-        while (!t.empty()) {
-            auto pos = t.find("mul");
-            if (pos == std::string::npos)
+        while (true) {
+            const auto pos = std::min(next_m, next_d);
+            if (pos >= end)
                 break;
-            t = t.substr(pos);
 
-            pos = t.find(')');
-            if (pos == std::string::npos)
-                break;
+            const auto rest = input.substr(pos);
+
+            if (pos == next_m) {
+                if (const auto m = mul_regex::match_prefix(rest)) {
+                    const auto product = to_int<size_t>((*m)[1]) * to_int<size_t>((*m)[2]);
+                    summary.sum += product;
 
-            const auto s = std::string { t.substr(0, pos + 1) };
+                    if (!summary.final_state)
+                        summary.sum_before_toggle += product;
+                    else if (*summary.final_state)
+                        summary.sum_enabled += product;
+                }
 
-            t = t.substr(pos + 1);
+                next_m = input.find('m', pos + 1);
+            } else {
+                if (rest.starts_with("do()"))
+                    summary.final_state = true;
+                else if (rest.starts_with("don't()"))
+                    summary.final_state = false;
 
-            std::smatch match;
-            if (std::regex_search(s, match, r)) {
-                const auto a = to_int(match[1].str());
-                const auto b = to_int(match[2].str());
-                sum += a * b;
+                next_d = input.find('d', pos + 1);
             }
         }
-    }
-
-    return sum;
-}
-
-size_t second_task()
-{
-    const std::regex r(R"(mul\((\d+),(\d+)\))");
-
-    size_t sum = 0;
 
-    constexpr auto tokens = std::to_array<std::pair<token_t, std::string_view>>({
-        { token_t::do_it, "do()" },
-        { token_t::mul, "mul(" },
-        { token_t::dont_do_it, "don't()" },
-    });
+        return summary;
+    }
 
-    bool active = true;
-    for (auto t : load_input_by_line()) {
-        while (!t.empty()) {
+    struct scan_result {
+        size_t sum = 0;
+        size_t sum_enabled = 0;
+    };
 
-            const auto next = find_next(t, tokens);
-            if (!next)
-                break;
+    // scans chunks of the whole input in parallel, the enabled state is carried across the chunk seams afterwards
+    scan_result scan(const std::string_view input)
+    {
+        const auto num_chunks = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(input.size(), 1));
+        const auto chunk_size = (input.size() + num_chunks - 1) / num_chunks;
 
-            if (next->token == token_t::do_it || next->token == token_t::dont_do_it) {
-                active = next->token == token_t::do_it;
-                t = t.substr(next->end);
-                continue;
-            }
+        const auto chunk_begins = std::views::iota(size_t { 0 }, num_chunks)
+            | std::views::transform([=](const size_t chunk) { return std::min(chunk * chunk_size, input.size()); })
+            | std::ranges::to<std::vector>();
 
-            t = t.substr(next->start);
+        std::vector<chunk_summary> summaries(num_chunks);
+        std::transform(std::execution::par, chunk_begins.begin(), chunk_begins.end(), summaries.begin(), [=](const size_t begin) {
+            return scan_chunk(input, begin, std::min(begin + chunk_size, input.size()));
+        });
 
-            auto end_pos = t.find(')');
-            if (end_pos == std::string::npos)
-                break;
+        scan_result result;
+        bool enabled = true;
 
-            end_pos += 1;
-            const auto s = std::string { t.substr(0, end_pos) };
-            std::smatch match;
-            if (std::regex_search(s, match, r)) {
-                const auto a = to_int(match[1].str());
-                const auto b = to_int(match[2].str());
-                if (active)
-                    sum += a * b;
-            }
-            t = t.substr(end_pos);
+        for (const auto& summary : summaries) {
+            result.sum += summary.sum;
+            result.sum_enabled += (enabled ? summary.sum_before_toggle : 0) + summary.sum_enabled;
+            enabled = summary.final_state.value_or(enabled);
         }
+
+        return result;
     }
+}
 
-    return sum;
+size_t first_task()
+{
+    return scan(load_input()).sum;
+}
+
+size_t second_task()
+{
+    return scan(load_input()).sum_enabled;
 }
 }
@@ -1,72 +1,162 @@
 #include <util.hpp>
 
-#include <optional>
-#include <regex>
+#include <bit>
 #include <utility>
 
 namespace aoc {
 namespace {
-    size_t calc_num_matches(const simple_mdarray<char>& input, const ptrdiff_t row, const ptrdiff_t col)
-    {
-        const auto access = [&](const ptrdiff_t r, const ptrdiff_t c) {
-            if (r < 0 || c < 0 || r >= input.rows() || c >= input.cols())
-                return '.';
-
-            return input[r, c];
-        };
-
-        size_t matches = 0;
-
-        constexpr auto directions = std::to_array<std::pair<int, int>>({
-            { -1, 0 }, // to top
-            { 1, 0 }, // to bottom
-            { 0, -1 }, // to left
-            { 0, 1 }, // to right
-            { -1, 1 }, // to top right
-            { -1, -1 }, // to top left
-            { 1, 1 }, // to bottom right
-            { 1, -1 }, // to bottom left
-        });
-
-        for (const auto [row_mult, col_mult] : directions) {
-            matches += //
-                access(row + 0, col + 0) == 'X' && //
-                access(row + 1 * row_mult, col + 1 * col_mult) == 'M' && //
-                access(row + 2 * row_mult, col + 2 * col_mult) == 'A' && //
-                access(row + 3 * row_mult, col + 3 * col_mult) == 'S';
+    // a letter expected at an offset relative to the start cell
+    struct tap {
+        ptrdiff_t row_offset = 0;
+        ptrdiff_t col_offset = 0;
+        char letter = 0;
+    };
+
+    // Counts occurrences of patterns of taps for all cells at once: each row is turned into one bitmask per letter,
+    // a tap then is the bitmask of its row shifted by its column offset and all taps of a pattern are ANDed together.
+    class word_search {
+    public:
+        explicit word_search(const simple_mdarray<char>& grid)
+            : grid_(grid)
+            , words_per_row_((grid.cols() + 63) / 64)
+        {
+        }
+
+        size_t count(const std::span<const tap> taps)
+        {
+            std::vector<uint64_t> matches(words_per_row_);
+            size_t num_matches = 0;
+
+            for (size_t row = 0; row < grid_.rows(); ++row) {
+                // only cells of the grid are valid start cells, not the padding bits of the last word
+                std::ranges::fill(matches, ~uint64_t { 0 });
+                if (const auto used_bits = grid_.cols() % 64; used_bits != 0)
+                    matches.back() = (uint64_t { 1 } << used_bits) - 1;
+
+                for (const auto& t : taps) {
+                    const auto tap_row = static_cast<ptrdiff_t>(row) + t.row_offset;
+
+                    if (tap_row < 0 || tap_row >= static_cast<ptrdiff_t>(grid_.rows())) {
+                        std::ranges::fill(matches, 0);
+                        break;
+                    }
+
+                    const auto* letter_row = letter_mask(t.letter).data() + tap_row * words_per_row_;
+                    for (size_t w = 0; w < words_per_row_; ++w)
+                        matches[w] &= shifted_word(letter_row, w, t.col_offset);
+                }
+
+                for (const auto m : matches)
+                    num_matches += std::popcount(m);
+            }
+
+            return num_matches;
+        }
+
+        // occurrences of word in all 8 directions
+        size_t count_word(const std::string_view word)
+        {
+            constexpr auto directions = std::to_array<std::pair<ptrdiff_t, ptrdiff_t>>({
+                { -1, 0 }, // to top
+                { 1, 0 }, // to bottom
+                { 0, -1 }, // to left
+                { 0, 1 }, // to right
+                { -1, 1 }, // to top right
+                { -1, -1 }, // to top left
+                { 1, 1 }, // to bottom right
+                { 1, -1 }, // to bottom left
+            });
+
+            size_t sum = 0;
+
+            for (const auto [row_mult, col_mult] : directions) {
+                const auto taps = word | std::views::enumerate | std::views::transform([=](const auto idx_and_letter) {
+                    const auto [idx, letter] = idx_and_letter;
+                    return tap { idx * row_mult, idx * col_mult, letter };
+                }) | std::ranges::to<std::vector>();
+
+                sum += count(taps);
+            }
+
+            return sum;
+        }
+
+        // occurrences of two copies of an odd length word crossing diagonally in their middle letter, each of them
+        // may be read in either direction
+        size_t count_x(const std::string_view word)
+        {
+            const auto reversed = word | std::views::reverse | std::ranges::to<std::string>();
+            const auto radius = static_cast<ptrdiff_t>(word.size() / 2);
+
+            std::vector<std::string_view> readings { word };
+            if (reversed != word)
+                readings.push_back(reversed);
+
+            size_t sum = 0;
+
+            for (const auto [first, second] : std::views::cartesian_product(readings, readings)) {
+                std::vector<tap> taps;
+
+                for (const auto [idx, letter] : first | std::views::enumerate)
+                    taps.push_back({ idx - radius, idx - radius, letter });
+
+                for (const auto [idx, letter] : second | std::views::enumerate)
+                    taps.push_back({ radius - idx, idx - radius, letter });
+
+                sum += count(taps);
+            }
+
+            return sum;
+        }
+
+    private:
+        // bit col of the result is bit col + offset of the row, bits outside of the row are zero
+        uint64_t shifted_word(const uint64_t* row, const size_t w, const ptrdiff_t offset) const
+        {
+            const auto word_at = [&](const ptrdiff_t idx) {
+                return idx >= 0 && idx < static_cast<ptrdiff_t>(words_per_row_) ? row[idx] : uint64_t { 0 };
+            };
+
+            const auto word_offset = offset >= 0 ? offset / 64 : -((-offset + 63) / 64);
+            const auto bit_offset = static_cast<unsigned>(offset - word_offset * 64);
+            const auto base = static_cast<ptrdiff_t>(w) + word_offset;
+
+            if (bit_offset == 0)
+                return word_at(base);
+
+            return (word_at(base) >> bit_offset) | (word_at(base + 1) << (64 - bit_offset));
+        }
+
+        const std::vector<uint64_t>& letter_mask(const char letter)
+        {
+            auto& mask = letter_masks_[static_cast<unsigned char>(letter)];
+
+            if (mask.empty()) {
+                mask.resize(grid_.rows() * words_per_row_);
+
+                for (size_t row = 0; row < grid_.rows(); ++row)
+                    for (size_t col = 0; col < grid_.cols(); ++col)
+                        mask[row * words_per_row_ + col / 64] |= uint64_t { grid_[row, col] == letter } << (col % 64);
+            }
+
+            return mask;
         }
 
-        return matches;
-    }
+        const simple_mdarray<char>& grid_;
+        size_t words_per_row_;
+        std::array<std::vector<uint64_t>, 256> letter_masks_;
+    };
 }
 
 size_t first_task()
 {
     const auto input = load_mdarray<char>(std::identity {});
-
-    size_t sum = 0;
-    for (ptrdiff_t row = 0; row < input.rows(); ++row)
-        for (ptrdiff_t col = 0; col < input.cols(); ++col)
-            sum += calc_num_matches(input, row, col);
-
-    return sum;
+    return word_search { input }.count_word("XMAS");
 }
 
 size_t second_task()
 {
     const auto input = load_mdarray<char>(std::identity {});
-
-    size_t sum = 0;
-    for (ptrdiff_t row = 0; row < input.rows() - 2; ++row)
-        for (ptrdiff_t col = 0; col < input.cols() - 2; ++col) {
-            const std::array first = { input[row, col], input[row + 1, col + 1], input[row + 2, col + 2] };
-            const std::array second = { input[row + 2, col], input[row + 1, col + 1], input[row, col + 2] };
-
-            const bool first_matches = std::ranges::equal(first, std::array { 'M', 'A', 'S' }) || std::ranges::equal(first, std::array { 'S', 'A', 'M' });
-            const bool second_matches = std::ranges::equal(second, std::array { 'M', 'A', 'S' }) || std::ranges::equal(second, std::array { 'S', 'A', 'M' });
-
-            sum += first_matches && second_matches;
-        }
-    return sum;
+    return word_search { input }.count_x("MAS");
 }
 }
@@ -1,54 +1,89 @@
+#include <algorithm>
+#include <execution>
+#include <numeric>
 #include <ranges>
+#include <span>
+#include <thread>
 #include <util.hpp>
 #include <vector>
 
 namespace aoc {
 namespace {
+    constexpr int64_t dial_size = 100;
+    constexpr int64_t start_position = 50;
 
-    std::vector<int> load_data()
+    std::vector<int64_t> load_data()
     {
         return load_input_by_line()
             | std::views::transform([](const auto& s) {
                   const auto sign = s[0] == 'L' ? -1 : 1;
-                  return sign * to_int(s.substr(1));
+                  return sign * to_int<int64_t>(s.substr(1));
               })
             | std::ranges::to<std::vector>();
     }
-}
 
-size_t first_task()
-{
-    const auto data = load_data();
+    constexpr int64_t floor_div(const int64_t a, const int64_t b)
+    {
+        return a / b - (a % b != 0 && (a < 0) != (b < 0));
+    }
+
+    // positions are not wrapped, the dial points at zero whenever the position is a multiple of the dial size
+    constexpr size_t zero_after_move(const int64_t position, const int64_t move)
+    {
+        return (position + move) % dial_size == 0;
+    }
+
+    // multiples of the dial size in (position, position + move] or [position + move, position) respectively
+    constexpr size_t zeros_during_move(const int64_t position, const int64_t move)
+    {
+        if (move >= 0)
+            return static_cast<size_t>(floor_div(position + move, dial_size) - floor_div(position, dial_size));
+
+        return static_cast<size_t>(floor_div(position - 1, dial_size) - floor_div(position + move - 1, dial_size));
+    }
+
+    static_assert(zeros_during_move(50, 1000) == 10);
+    static_assert(zeros_during_move(50, -68) == 1);
+    static_assert(zeros_during_move(0, -5) == 0);
+    static_assert(zeros_during_move(-100, 100) == 1);
+    static_assert(zeros_during_move(5, -5) == 1);
+
+    // The moves are split into chunks, the start position of each chunk is the exclusive prefix sum of the chunk
+    // totals, so all chunks can be counted independently.
+    size_t count_zeros(const std::span<const int64_t> moves, const auto zeros_of_move)
+    {
+        const auto num_chunks = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, std::max<size_t>(moves.size(), 1));
+        const auto chunk_size = (moves.size() + num_chunks - 1) / num_chunks;
+
+        const auto chunks = std::views::iota(size_t { 0 }, num_chunks) | std::views::transform([&](const size_t chunk) {
+            const auto first = std::min(chunk * chunk_size, moves.size());
+            return moves.subspan(first, std::min(chunk_size, moves.size() - first));
+        }) | std::ranges::to<std::vector>();
+
+        std::vector<int64_t> start_positions(num_chunks);
+        std::transform(std::execution::par, chunks.begin(), chunks.end(), start_positions.begin(),
+            [](const std::span<const int64_t> chunk) { return std::reduce(chunk.begin(), chunk.end(), int64_t { 0 }); });
+        std::exclusive_scan(start_positions.begin(), start_positions.end(), start_positions.begin(), start_position);
 
-    int cnt = 0;
-    int val = 50;
-    for (const auto v : data) {
-        val = (val + v) % 100;
-        cnt += val == 0;
+        return std::transform_reduce(std::execution::par, chunks.begin(), chunks.end(), start_positions.begin(), size_t { 0 }, std::plus {},
+            [&](const std::span<const int64_t> chunk, int64_t position) {
+                size_t cnt = 0;
+                for (const auto move : chunk) {
+                    cnt += zeros_of_move(position, move);
+                    position += move;
+                }
+                return cnt;
+            });
     }
+}
 
-    return cnt;
+size_t first_task()
+{
+    return count_zeros(load_data(), zero_after_move);
 }
 
 size_t second_task()
 {
-    const auto data = load_data();
-    int cnt = 0;
-    int val = 50;
-    for (const auto v : data) {
-        const auto add = v < 0 ? -1 : 1;
-
-        // not very elegant, but works
-        for (int i = 0; i < std::abs(v); ++i) {
-            val += add;
-            if (val == 100)
-                val = 0;
-            else if (val == -1)
-                val = 99;
-            cnt += val == 0;
-        }
-    }
-
-    return cnt;
+    return count_zeros(load_data(), zeros_during_move);
 }
 }
@@ -1,6 +1,11 @@
+#include <algorithm>
+#include <array>
+#include <execution>
+#include <interval_set.hpp>
+#include <numeric>
 #include <ranges>
-#include <set>
 #include <util.hpp>
+#include <utility>
 #include <vector>
 
 namespace aoc {
@@ -30,72 +35,99 @@ namespace {
         return n == 0 ? 1 : 10 * pow_10(n - 1);
     }
 
-    constexpr int64_t select_digits(int64_t x, int64_t start, int64_t len)
+    // Sum of the numbers in [first, last] with num_digits digits that consist of a block of width digits repeated.
+    // These are exactly the multiples block * 10..010..01 with a block of width digits, so the sum is an arithmetic
+    // series over the blocks.
+    constexpr int64_t sum_of_repetitions(const int64_t first, const int64_t last, const int64_t num_digits, const int64_t width)
     {
-        const auto t = x / pow_10(start);
-        return t - (t / pow_10(len)) * pow_10(len);
+        int64_t repunit = 0;
+        for (int64_t i = 0; i < num_digits; i += width)
+            repunit = repunit * pow_10(width) + 1;
+
+        const auto first_block = std::max(pow_10(width - 1), (first + repunit - 1) / repunit);
+        const auto last_block = std::min(pow_10(width) - 1, last / repunit);
+
+        if (first_block > last_block)
+            return 0;
+
+        return repunit * ((first_block + last_block) * (last_block - first_block + 1) / 2);
     }
-}
 
-size_t first_task()
-{
-    size_t sum = 0;
-    for (auto [range_start, range_end] : load_data()) {
-        while (range_start <= range_end) {
-            const auto num_digits = log_10(range_start);
-            if (num_digits % 2 != 0) {
-                const auto next_power_of_10 = pow_10(num_digits);
-                if (next_power_of_10 > range_end)
-                    break;
-                range_start = next_power_of_10;
-                continue;
-            }
+    // like sum_of_repetitions, but only numbers whose shortest repeated block has exactly width digits, the ones
+    // with a shorter block (which divides width) are removed by inclusion-exclusion
+    constexpr int64_t sum_of_primitive_repetitions(const int64_t first, const int64_t last, const int64_t num_digits, const int64_t width)
+    {
+        auto sum = sum_of_repetitions(first, last, num_digits, width);
+
+        for (int64_t divisor = 1; divisor < width; ++divisor) {
+            if (width % divisor == 0)
+                sum -= sum_of_primitive_repetitions(first, last, num_digits, divisor);
+        }
 
-            const auto len = num_digits / 2;
-            const auto upper_half = select_digits(range_start, len, len);
-            const auto lower_half = select_digits(range_start, 0, len);
+        return sum;
+    }
 
-            if (upper_half == lower_half) {
-                sum += range_start;
-            }
+    // numbers made of a block repeated exactly twice
+    constexpr int64_t sum_of_doubled(const int64_t first, const int64_t last)
+    {
+        int64_t sum = 0;
 
-            range_start++;
+        for (auto num_digits = log_10(first); num_digits <= log_10(last); ++num_digits) {
+            if (num_digits % 2 == 0)
+                sum += sum_of_repetitions(first, last, num_digits, num_digits / 2);
         }
+
+        return sum;
     }
-    return sum;
-}
 
-size_t second_task()
-{
-    // 222222 is a valid combination for 22 22 22 and 222 222, so we need to
-    // filter the duplicates.
-    std::set<int64_t> seen;
-
-    for (auto [range_start, range_end] : load_data()) {
-        while (range_start <= range_end) {
-            const auto num_digits = log_10(range_start);
-
-            for (int64_t width = 1; width < num_digits; width++) {
-                if (num_digits % width != 0)
-                    continue;
-
-                bool all_match = true;
-
-                int64_t first = 0;
-                for (int64_t start = 0; start + width <= num_digits; start += width) {
-                    if (start == 0)
-                        first = select_digits(range_start, start, width);
-                    else
-                        all_match &= first == select_digits(range_start, start, width);
-                }
-
-                if (all_match)
-                    seen.insert(range_start);
+    // numbers made of a block repeated at least twice, each number is counted once under its shortest block
+    constexpr int64_t sum_of_repeated(const int64_t first, const int64_t last)
+    {
+        int64_t sum = 0;
+
+        for (auto num_digits = log_10(first); num_digits <= log_10(last); ++num_digits) {
+            for (int64_t width = 1; width < num_digits; ++width) {
+                if (num_digits % width == 0)
+                    sum += sum_of_primitive_repetitions(first, last, num_digits, width);
             }
-            range_start++;
         }
+
+        return sum;
+    }
+
+    constexpr auto example = std::to_array<std::pair<int64_t, int64_t>>({ { 11, 22 }, { 95, 115 }, { 998, 1012 },
+        { 1188511880, 1188511890 }, { 222220, 222224 }, { 1698522, 1698528 }, { 446443, 446449 }, { 38593856, 38593862 },
+        { 565653, 565659 }, { 824824821, 824824827 }, { 2121212118, 2121212124 } });
+
+    constexpr int64_t sum_over_ranges(const auto& ranges, const auto sum_of_range)
+    {
+        int64_t sum = 0;
+        for (const auto [first, last] : ranges)
+            sum += sum_of_range(first, last);
+        return sum;
+    }
+
+    static_assert(sum_over_ranges(example, sum_of_doubled) == 1227775554);
+    static_assert(sum_over_ranges(example, sum_of_repeated) == 4174379265);
+
+    // the ranges are merged first, so that ids covered by overlapping ranges are summed only once
+    size_t sum_over_ranges_par(std::vector<std::pair<int64_t, int64_t>> ranges, const auto sum_of_range)
+    {
+        const interval_set merged { std::move(ranges) };
+        const auto intervals = merged.intervals();
+
+        return std::transform_reduce(std::execution::par, intervals.begin(), intervals.end(), size_t { 0 }, std::plus {},
+            [&](const std::pair<int64_t, int64_t>& range) { return static_cast<size_t>(sum_of_range(range.first, range.second)); });
     }
+}
 
-    return std::ranges::fold_left_first(seen, std::plus {}).value();
+size_t first_task()
+{
+    return sum_over_ranges_par(load_data(), sum_of_doubled);
+}
+
+size_t second_task()
+{
+    return sum_over_ranges_par(load_data(), sum_of_repeated);
 }
 }
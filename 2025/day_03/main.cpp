@@ -1,57 +1,102 @@
+#include <algorithm>
+#include <array>
+#include <execution>
+#include <iterator>
+#include <numeric>
 #include <ranges>
-#include <set>
+#include <span>
 #include <util.hpp>
 #include <vector>
 
 namespace aoc {
 namespace {
 
-    using bank = std::array<int, 100>;
+    // all banks back to back as digit values, bank i spans the digits [offsets[i], offsets[i + 1])
+    class bank_batch {
+    public:
+        void add(const std::string_view line)
+        {
+            if (!std::ranges::all_of(line, is_digit))
+                throw std::invalid_argument("bank must only contain digits");
 
-    std::vector<bank> load_data()
+            std::ranges::transform(line, std::back_inserter(digits_), [](const char c) { return static_cast<uint8_t>(c - '0'); });
+            offsets_.push_back(digits_.size());
+        }
+
+        [[nodiscard]] size_t size() const
+        {
+            return offsets_.size() - 1;
+        }
+
+        [[nodiscard]] std::span<const uint8_t> operator[](const size_t i) const
+        {
+            return std::span { digits_ }.subspan(offsets_[i], offsets_[i + 1] - offsets_[i]);
+        }
+
+    private:
+        std::vector<uint8_t> digits_;
+        std::vector<size_t> offsets_ { 0 };
+    };
+
+    bank_batch load_data()
     {
-        return load_input_by_line() //
-            | std::views::transform([](const std::string_view& s) {
-                  bank r {};
-                  for (size_t i = 0; i < s.size(); ++i)
-                      r[i] = to_int(s.substr(i, 1));
-
-                  return r;
-              })
-            | std::ranges::to<std::vector>();
+        bank_batch batch;
+        for (const auto line : load_input_by_line())
+            batch.add(line);
+
+        return batch;
     }
 
-    size_t find_joltage_n(const bank b, const size_t n)
+    // Largest number formed by N of the digits in their order. A digit pops every smaller digit off the stack as
+    // long as enough digits remain to fill it again, once the stack is full the remaining smaller digits are dropped.
+    template <size_t N>
+    constexpr uint64_t find_joltage_n(const std::span<const uint8_t> b)
     {
-        size_t result = 0;
+        static_assert(N > 0 && N <= 19, "the joltage has to fit into 64 bits");
 
-        auto start = b.begin();
-        for (size_t i = 0; i < n; ++i) {
-            // limit lookahead
-            const auto end = b.end() - (n - i) + 1;
-            const std::forward_iterator auto max = std::ranges::max_element(start, end);
-            start = max + 1;
+        std::array<uint8_t, N> selected {};
+        size_t num_selected = 0;
 
-            result = result * 10 + *max;
+        for (size_t i = 0; i < b.size(); ++i) {
+            const auto remaining = b.size() - i;
+
+            while (num_selected > 0 && selected[num_selected - 1] < b[i] && num_selected - 1 + remaining >= N)
+                --num_selected;
+
+            if (num_selected < N)
+                selected[num_selected++] = b[i];
         }
 
-        return result;
+        return std::accumulate(selected.begin(), selected.begin() + num_selected, uint64_t { 0 },
+            [](const uint64_t acc, const uint8_t digit) { return acc * 10 + digit; });
+    }
+
+    static_assert(find_joltage_n<2>(std::to_array<uint8_t>({ 9, 8, 7, 6, 5, 4, 3, 2, 1, 1, 1, 1, 1, 1, 1 })) == 98);
+    static_assert(find_joltage_n<2>(std::to_array<uint8_t>({ 8, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 9 })) == 89);
+    static_assert(find_joltage_n<12>(std::to_array<uint8_t>({ 2, 3, 4, 2, 3, 4, 2, 3, 4, 2, 3, 4, 2, 7, 8 })) == 434234234278);
+    static_assert(find_joltage_n<12>(std::to_array<uint8_t>({ 8, 1, 8, 1, 8, 1, 9, 1, 1, 1, 1, 2, 1, 1, 1 })) == 888911112111);
+
+    // the banks are independent and the selection needs no allocation, so they are evaluated with par_unseq
+    template <size_t N>
+    size_t total_joltage(const bank_batch& banks)
+    {
+        const auto indices = index_vector(banks.size());
+
+        if (std::ranges::any_of(indices, [&](const size_t i) { return banks[i].size() < N; }))
+            throw std::invalid_argument("bank has too few batteries");
+
+        return std::transform_reduce(std::execution::par_unseq, indices.begin(), indices.end(), size_t { 0 }, std::plus {},
+            [&](const size_t i) { return static_cast<size_t>(find_joltage_n<N>(banks[i])); });
     }
 }
 
 size_t first_task()
 {
-    return std::ranges::fold_left_first(load_data() //
-            | std::views::transform(std::bind_back(find_joltage_n, 2)),
-        std::plus {})
-        .value();
+    return total_joltage<2>(load_data());
 }
 
 size_t second_task()
 {
-    return std::ranges::fold_left_first(load_data() //
-            | std::views::transform(std::bind_back(find_joltage_n, 12)),
-        std::plus {})
-        .value();
+    return total_joltage<12>(load_data());
 }
 }
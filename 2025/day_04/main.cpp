@@ -1,66 +1,81 @@
+#include <grid.hpp>
 #include <util.hpp>
 
 namespace aoc {
 namespace {
-    void calculate_density(const simple_mdarray<char>& input, simple_mdarray<int>& result)
+    constexpr auto is_roll = [](const char c) { return c == '@'; };
+
+    // a roll is accessible if fewer rolls than this are adjacent to it
+    constexpr uint8_t max_neighbors = 4;
+
+    // number of rolls among the 8 neighbors of every cell
+    simple_mdarray<uint8_t> count_neighbors(const simple_mdarray<char>& input)
+    {
+        return apply_stencil<moore_neighborhood>(
+            std::execution::par, input, [](char, const std::array<char, moore_neighborhood.size()>& neighbors) {
+                return static_cast<uint8_t>(std::ranges::count_if(neighbors, is_roll));
+            },
+            '.');
+    }
+
+    // Removes accessible rolls until none is left and returns the number of removed rolls. The neighbor counts are
+    // computed once, each removal decrements the counts of its neighbors and queues the rolls that become accessible,
+    // so every roll is removed at most once instead of rescanning the grid each round.
+    size_t peel_rolls(const simple_mdarray<char>& input)
     {
-        for (ptrdiff_t row = 0; row < input.rows(); ++row)
-            for (ptrdiff_t col = 0; col < input.cols(); ++col) {
-                int sum = 0;
+        auto neighbor_counts = count_neighbors(input);
+        // rolls that are queued or already removed
+        simple_mdarray<uint8_t> peeled(input.rows(), input.cols());
+        std::vector<std::pair<size_t, size_t>> worklist;
+
+        for (size_t row = 0; row < input.rows(); ++row) {
+            for (size_t col = 0; col < input.cols(); ++col) {
+                if (is_roll(input[row, col]) && neighbor_counts[row, col] < max_neighbors) {
+                    peeled[row, col] = true;
+                    worklist.emplace_back(row, col);
+                }
+            }
+        }
 
-                for (ptrdiff_t row_offs = -1; row_offs <= 1; ++row_offs)
-                    for (ptrdiff_t col_offs = -1; col_offs <= 1; ++col_offs) {
-                        const auto final_row = row + row_offs;
-                        const auto final_col = col + col_offs;
+        size_t num_removed = 0;
 
-                        const auto inside_bounds = final_row >= 0 && final_row < input.rows() && final_col >= 0 && final_col < input.cols();
-                        const auto is_self = row_offs == 0 && col_offs == 0;
+        while (!worklist.empty()) {
+            const auto [row, col] = worklist.back();
+            worklist.pop_back();
+            ++num_removed;
 
-                        if (!is_self)
-                            sum += inside_bounds && input[final_row, final_col] == '@';
-                    }
+            for (size_t n_row = row > 0 ? row - 1 : row; n_row <= std::min(row + 1, input.rows() - 1); ++n_row) {
+                for (size_t n_col = col > 0 ? col - 1 : col; n_col <= std::min(col + 1, input.cols() - 1); ++n_col) {
+                    if (!is_roll(input[n_row, n_col]) || peeled[n_row, n_col])
+                        continue;
 
-                result[row, col] = sum;
+                    if (--neighbor_counts[n_row, n_col] < max_neighbors) {
+                        peeled[n_row, n_col] = true;
+                        worklist.emplace_back(n_row, n_col);
+                    }
+                }
             }
+        }
+
+        return num_removed;
     }
 }
 
 size_t first_task()
 {
     const auto input = load_mdarray<char>(std::identity {});
-    simple_mdarray<int> density(input.rows(), input.cols());
-    calculate_density(input, density);
+    const auto neighbor_counts = count_neighbors(input);
 
-    return std::ranges::count_if(std::views::zip(input.data(), density.data()), [](const auto& input_and_density) {
-        const auto [i, d] = input_and_density;
-        return i == '@' && d < 4;
-    });
+    size_t sum = 0;
+    for (size_t row = 0; row < input.rows(); ++row)
+        for (size_t col = 0; col < input.cols(); ++col)
+            sum += is_roll(input[row, col]) && neighbor_counts[row, col] < max_neighbors;
+
+    return sum;
 }
 
 size_t second_task()
 {
-    int sum = 0;
-
-    auto input = load_mdarray<char>(std::identity {});
-    simple_mdarray<int> density(input.rows(), input.cols());
-
-    while(true)
-    {
-        const auto sum_old = sum;
-        calculate_density(input, density);
-        for (auto&& [i, d] : std::views::zip(input.data(), density.data()))
-        {
-            if (i == '@' && d < 4)
-            {
-                ++sum;
-                i = 'x';
-            }
-        }
-
-        if (sum_old == sum)
-            break;
-    }
-
-    return sum;
+    return peel_rolls(load_mdarray<char>(std::identity {}));
+}
 }
-}
\ No newline at end of file
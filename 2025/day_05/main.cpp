@@ -1,5 +1,8 @@
+#include <interval_set.hpp>
 #include <util.hpp>
 
+#include <execution>
+
 namespace aoc {
 namespace {
     using value_type = int64_t;
@@ -26,40 +29,16 @@ namespace {
 
 size_t first_task()
 {
-    const auto [ranges, ingredients] = load_data();
-
-    const auto is_fresh = [&](const value_type ingredient) {
-        return std::ranges::any_of(ranges, [=](const auto& interval) {
-            return interval.first <= ingredient && ingredient <= interval.second;
-        });
-    };
+    auto [ranges, ingredients] = load_data();
+    const interval_set fresh { std::move(ranges) };
 
-    return std::ranges::count_if(ingredients, is_fresh);
+    std::sort(std::execution::par, ingredients.begin(), ingredients.end());
+    return fresh.count_contained(ingredients);
 }
 
 size_t second_task()
 {
-    const auto [ranges, _] = load_data();
-
-    auto sorted_ranges = ranges;
-    std::ranges::sort(sorted_ranges);
-
-    auto current_interval = sorted_ranges.begin();
-    for (auto it = sorted_ranges.begin() + 1; it != sorted_ranges.end(); ++it) {
-        if (current_interval->second >= it->first) {
-            current_interval->second = std::max(current_interval->second, it->second);
-            it->first = -1; // mark as invalidated
-        } else {
-            current_interval = it;
-        }
-    }
-
-    return std::ranges::fold_left_first(sorted_ranges | std::views::transform([](const auto& interval) -> value_type {
-        if (interval.first == -1)
-            return 0;
-        return interval.second - interval.first + 1;
-    }),
-        std::plus {})
-        .value();
+    auto [ranges, _] = load_data();
+    return interval_set { std::move(ranges) }.coverage();
+}
 }
-}
\ No newline at end of file
@@ -1,4 +1,3 @@
-#include <cassert>
 #include <util.hpp>
 
 namespace aoc {
@@ -10,80 +9,136 @@ namespace {
         mult = '*'
     };
 
-    auto extract_row(auto&& row)
+    constexpr op to_op(const char c)
     {
-        return row //
-            | std::views::chunk_by([](const auto a, const auto b) { return !(a == ' ' || b == ' '); }) //
-            | std::views::transform(as_string_view) //
-            | std::views::filter([](const auto s) { return s != " "; });
+        if (c != std::to_underlying(op::plus) && c != std::to_underlying(op::mult))
+            throw std::invalid_argument("unknown operator");
+
+        return static_cast<op>(c);
     }
 
-    auto load_data_task_1()
+    constexpr value_type identity_of(const op op)
     {
-        const auto num_rows = std::ranges::distance(load_input_by_line());
-        const auto num_cols = std::ranges::distance(extract_row(*load_input_by_line().begin()));
+        return op == op::plus ? 0 : 1;
+    }
 
-        simple_mdarray<value_type> numbers(num_rows - 1, num_cols);
+    constexpr value_type apply(const op op, const value_type a, const value_type b)
+    {
+        return op == op::plus ? a + b : a * b;
+    }
 
-        for (auto&& [row_idx, row] : std::views::enumerate(load_input_by_line() | std::views::take(num_rows - 1))) {
-            for (auto&& [col_idx, val] : std::views::enumerate(extract_row(row))) {
-                numbers[row_idx, col_idx] = to_int<value_type>(val);
+    struct worksheet_sums {
+        value_type row_wise = 0;
+        value_type col_wise = 0;
+    };
+
+    // Evaluates both readings of the worksheet in a single pass over the rows of numbers. Each problem starts at the
+    // column of its operator in the last line and ends where the next one starts. Row-wise numbers are accumulated
+    // per problem while a row is read, column-wise numbers gain one digit per row.
+    constexpr worksheet_sums evaluate_worksheet(std::string_view input)
+    {
+        while (!input.empty() && (input.back() == '\n' || input.back() == ' '))
+            input.remove_suffix(1);
+
+        const auto ops_begin = input.rfind('\n') + 1;
+        const auto ops_line = input.substr(ops_begin);
+        auto number_rows = input.substr(0, ops_begin);
+
+        struct problem {
+            size_t first_col = 0;
+            op operation = op::plus;
+            value_type row_wise = 0;
+        };
+
+        std::vector<problem> problems;
+        for (size_t col = 0; col < ops_line.size(); ++col) {
+            if (ops_line[col] != ' ') {
+                const auto o = to_op(ops_line[col]);
+                problems.push_back({ .first_col = col, .operation = o, .row_wise = identity_of(o) });
             }
         }
 
-        auto ops = extract_row(*(load_input_by_line() | std::views::drop(num_rows - 1)).begin()) | std::views::transform([](const auto s) {
-            assert(s.length() == 1);
-            return static_cast<op>(s[0]);
-        }) | std::ranges::to<std::vector>();
+        if (problems.empty() || problems.front().first_col != 0)
+            throw std::invalid_argument("worksheet must start with an operator");
 
-        return std::tuple { numbers, ops };
-    }
+        std::vector<value_type> col_numbers;
+        std::vector<uint8_t> col_has_digits;
 
-    constexpr value_type fold_with_op(auto&& range, const op op)
-    {
-        if (op == op::plus)
-            return std::ranges::fold_left_first(range, std::plus {}).value();
-        else
-            return std::ranges::fold_left_first(range, std::multiplies {}).value();
-    }
-}
+        while (!number_rows.empty()) {
+            const auto row = number_rows.substr(0, number_rows.find('\n'));
+            number_rows.remove_prefix(std::min(row.size() + 1, number_rows.size()));
 
-size_t first_task()
-{
-    const auto [data, ops] = load_data_task_1();
+            if (row.size() > col_numbers.size()) {
+                col_numbers.resize(row.size());
+                col_has_digits.resize(row.size());
+            }
 
-    value_type sum = 0;
-    for (ptrdiff_t col = 0; col < data.cols(); ++col)
-        sum += fold_with_op(col_view(col, data), ops[col]);
+            size_t p = 0;
+            value_type number = 0;
+            bool has_number = false;
 
-    return sum;
-}
+            const auto finish_number = [&] {
+                if (has_number)
+                    problems[p].row_wise = apply(problems[p].operation, problems[p].row_wise, number);
 
-size_t second_task()
-{
-    constexpr auto is_whitespace = [](const char c) { return c == ' '; };
-    constexpr auto drop_leading_whitespaces = std::views::drop_while(is_whitespace);
+                number = 0;
+                has_number = false;
+            };
 
-    const auto char_map = load_mdarray<char>(std::identity {});
+            for (size_t col = 0; col < row.size(); ++col) {
+                while (p + 1 < problems.size() && col >= problems[p + 1].first_col) {
+                    finish_number();
+                    ++p;
+                }
 
-    value_type sum = 0;
-    std::vector<value_type> numbers;
+                if (!is_digit(row[col]))
+                    continue;
 
-    for (const auto& col : colwise(char_map) | std::views::reverse) {
-        if (std::ranges::all_of(col, is_whitespace))
-            continue;
+                const auto digit = static_cast<value_type>(row[col] - '0');
+                number = number * 10 + digit;
+                has_number = true;
 
-        if (col.back() != std::to_underlying(op::plus) && col.back() != std::to_underlying(op::mult)) {
-            numbers.push_back(to_int<value_type>(col | drop_leading_whitespaces | std::ranges::to<std::string>()));
-            continue;
+                col_numbers[col] = col_numbers[col] * 10 + digit;
+                col_has_digits[col] = true;
+            }
+
+            finish_number();
         }
 
-        numbers.push_back(to_int<value_type>(col | std::views::take(char_map.rows() - 1) | drop_leading_whitespaces | std::ranges::to<std::string>()));
-        sum += fold_with_op(numbers, static_cast<op>(col.back()));
+        worksheet_sums sums;
+
+        for (size_t p = 0; p < problems.size(); ++p) {
+            const auto last_col = p + 1 < problems.size() ? problems[p + 1].first_col : col_numbers.size();
+
+            value_type col_wise = identity_of(problems[p].operation);
+            for (size_t col = problems[p].first_col; col < std::min(last_col, col_numbers.size()); ++col) {
+                if (col_has_digits[col])
+                    col_wise = apply(problems[p].operation, col_wise, col_numbers[col]);
+            }
 
-        numbers.clear();
+            sums.row_wise += problems[p].row_wise;
+            sums.col_wise += col_wise;
+        }
+
+        return sums;
     }
 
-    return sum;
+    constexpr std::string_view example = "123 328  51 64 \n"
+                                         " 45 64  387 23 \n"
+                                         "  6 98  215 314\n"
+                                         "*   +   *   +  \n";
+
+    static_assert(evaluate_worksheet(example).row_wise == 4277556);
+    static_assert(evaluate_worksheet(example).col_wise == 3263827);
+}
+
+size_t first_task()
+{
+    return evaluate_worksheet(load_input()).row_wise;
+}
+
+size_t second_task()
+{
+    return evaluate_worksheet(load_input()).col_wise;
+}
 }
-}
\ No newline at end of file
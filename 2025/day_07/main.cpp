@@ -1,4 +1,4 @@
-#include <cassert>
+#include <bit>
 #include <util.hpp>
 
 namespace aoc {
@@ -9,103 +9,134 @@ namespace {
         empty = '.',
         start = 'S',
         splitter = '^',
-        visited = '#',
     };
 
-    void print(const simple_mdarray<field>& map)
-    {
-        for (size_t r = 0; r < map.rows(); ++r) {
-            for (size_t c = 0; c < map.cols(); ++c)
-                std::cout << static_cast<char>(map[r, c]);
-            std::cout << '\n';
-        }
-        std::cout << '\n';
-    }
+    struct manifold_result {
+        size_t num_splits = 0;
+        value_type num_timelines = 0;
+    };
 
-    size_t trace_ray(simple_mdarray<field>& map, size_t row, const size_t col)
-    {
-        if (row >= map.rows() || col >= map.cols())
-            return 0;
+    // columns with a beam, one bit per column
+    using beam_row = std::vector<uint64_t>;
 
-        auto current = map[row, col];
+    // Sweeps the manifold row by row, keeping only the current row. The beams are a bitset, the beams hitting a
+    // splitter are the AND with the splitters of the row and continue shifted by one column to both sides. The number of
+    // timelines per column is a single row, in which only the counts of the hit columns are moved to their neighbors.
+    constexpr manifold_result simulate_beams(std::string_view input)
+    {
+        size_t cols = 0;
+        beam_row beams;
+        beam_row splitters;
+        beam_row hits;
+        std::vector<value_type> timelines;
+        // (column, number of timelines) of the hit columns of the current row
+        std::vector<std::pair<size_t, value_type>> split_timelines;
+
+        manifold_result result;
+
+        while (!input.empty()) {
+            const auto row = input.substr(0, input.find('\n'));
+            input.remove_prefix(std::min(row.size() + 1, input.size()));
+
+            if (row.empty())
+                continue;
+
+            if (cols == 0) {
+                const auto start_pos = row.find(static_cast<char>(field::start));
+                if (start_pos == std::string_view::npos)
+                    throw std::invalid_argument("no start position found");
+
+                cols = row.size();
+                beams.assign((cols + 63) / 64, 0);
+                beams[start_pos / 64] |= uint64_t { 1 } << (start_pos % 64);
+                timelines.assign(cols, 0);
+                timelines[start_pos] = 1;
+                continue;
+            }
 
-        while (current != field::splitter && current != field::visited) {
-            ++row;
-            if (row >= map.rows())
-                return 0;
-            current = map[row, col];
-        }
+            if (row.size() != cols)
+                throw std::invalid_argument("all rows must have the same length");
 
-        if (current == field::visited)
-            return 0;
+            splitters.assign(beams.size(), 0);
+            for (size_t col = 0; col < cols; ++col) {
+                if (row[col] == static_cast<char>(field::splitter))
+                    splitters[col / 64] |= uint64_t { 1 } << (col % 64);
+                else if (row[col] != static_cast<char>(field::empty))
+                    throw std::invalid_argument("invalid character in map");
+            }
 
-        map[row, col] = field::visited;
+            hits.resize(beams.size());
+            for (size_t w = 0; w < beams.size(); ++w) {
+                hits[w] = beams[w] & splitters[w];
+                result.num_splits += static_cast<size_t>(std::popcount(hits[w]));
+            }
 
-        return 1 + trace_ray(map, row, col - 1) + trace_ray(map, row, col + 1);
-    }
+            // a hit in column c continues in the columns c - 1 and c + 1
+            for (size_t w = 0; w < beams.size(); ++w) {
+                const auto from_right = (hits[w] >> 1) | (w + 1 < hits.size() ? hits[w + 1] << 63 : 0);
+                const auto from_left = (hits[w] << 1) | (w > 0 ? hits[w - 1] >> 63 : 0);
+                beams[w] = (beams[w] & ~hits[w]) | from_left | from_right;
+            }
 
-    auto load_map()
-    {
-        auto map = load_mdarray<field>([](const char c) {
-            for (const auto t : { field::empty, field::start, field::splitter }) {
-                if (static_cast<char>(t) == c)
-                    return t;
+            if (const auto used_bits = cols % 64; used_bits != 0)
+                beams.back() &= (uint64_t { 1 } << used_bits) - 1;
+
+            // the counts of all hit columns are taken out first, so a hit next to another one doesn't pass on counts
+            // it received in the same row
+            split_timelines.clear();
+            for (size_t w = 0; w < hits.size(); ++w) {
+                for (auto word = hits[w]; word != 0; word &= word - 1) {
+                    const auto col = w * 64 + static_cast<size_t>(std::countr_zero(word));
+                    split_timelines.emplace_back(col, timelines[col]);
+                    timelines[col] = 0;
+                }
             }
-            throw std::invalid_argument("invalid character in map");
-        });
 
-        const auto start_pos = [&] {
-            const auto first_row = row_view(0, map) | std::views::enumerate;
-            const auto it = std::ranges::find_if(first_row, [](const auto rc) {
-                const auto [r, val] = rc;
-                return val == field::start;
-            });
+            for (const auto [col, num_timelines] : split_timelines) {
+                if (col > 0)
+                    timelines[col - 1] += num_timelines;
+                if (col + 1 < cols)
+                    timelines[col + 1] += num_timelines;
+            }
+        }
 
-            if (it == first_row.end())
-                throw std::invalid_argument("no start position found");
+        if (cols == 0)
+            throw std::invalid_argument("empty map");
 
-            const auto [idx, _] = *it;
-            return idx;
-        }();
+        for (const auto t : timelines)
+            result.num_timelines += t;
 
-        return std::tuple { std::move(map), start_pos };
+        return result;
     }
+
+    constexpr std::string_view example = ".......S.......\n"
+                                         "...............\n"
+                                         ".......^.......\n"
+                                         "...............\n"
+                                         "......^.^......\n"
+                                         "...............\n"
+                                         ".....^.^.^.....\n"
+                                         "...............\n"
+                                         "....^.^...^....\n"
+                                         "...............\n"
+                                         "...^.^...^.^...\n"
+                                         "...............\n"
+                                         "..^...^.....^..\n"
+                                         "...............\n"
+                                         ".^.^.^.^.^...^.\n"
+                                         "...............\n";
+
+    static_assert(simulate_beams(example).num_splits == 21);
+    static_assert(simulate_beams(example).num_timelines == 40);
 }
 
 size_t first_task()
 {
-    auto [map, start_pos] = load_map();
-    return trace_ray(map, 0, start_pos);
+    return simulate_beams(load_input()).num_splits;
 }
 
 size_t second_task()
 {
-    auto [map, start_pos] = load_map();
-    simple_mdarray<value_type> scores(map.rows(), map.cols());
-
-    scores[0, start_pos] = 1;
-    for (size_t r = 1; r < map.rows(); ++r) {
-        std::ranges::copy(row_view(r - 1, scores), row_view(r, scores).begin());
-
-        const auto indices_of_splitters = row_view(r, map)
-            | std::views::enumerate
-            | std::views::filter([&](const auto rc) {
-                  const auto [c, val] = rc;
-                  return val == field::splitter;
-              })
-            | std::views::transform([](const auto rc) {
-                  const auto [c, _] = rc;
-                  return c;
-              })
-            | std::ranges::to<std::vector>();
-
-        for (const auto col : indices_of_splitters) {
-            scores[r, col - 1] += scores[r, col];
-            scores[r, col + 1] += scores[r, col];
-            scores[r, col] = 0;
-        }
-    }
-
-    return std::ranges::fold_left_first(row_view(scores.rows() - 1, scores), std::plus {}).value();
+    return simulate_beams(load_input()).num_timelines;
+}
 }
-}
\ No newline at end of file
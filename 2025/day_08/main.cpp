@@ -2,6 +2,7 @@
 #include <cassert>
 #include <execution>
 #include <mutex>
+#include <parse.hpp>
 #include <thread>
 #include <unordered_set>
 #include <util.hpp>
@@ -14,11 +15,10 @@ namespace {
 
     std::vector<point> load_data()
     {
-        return load_input_by_line() | std::views::transform([](const std::string_view line) {
-            point p;
-            std::sscanf(std::string(line).c_str(), "%ld,%ld,%ld", &p[0], &p[1], &p[2]);
-            return p;
-        })
+        constexpr auto coordinate = parse::signed_number<value_type>;
+        constexpr auto point_parser = parse::into<point>(parse::seq(coordinate, ",", coordinate, ",", coordinate));
+
+        return load_input_by_line() | std::views::transform([&](const std::string_view line) { return parse::parse_line(point_parser, line); })
             | std::ranges::to<std::vector>();
     }
 
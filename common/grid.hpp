@@ -0,0 +1,623 @@
+#pragma once
+
+#include <util.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <execution>
+#include <initializer_list>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aoc {
+
+enum class adjacency {
+    horizontal,
+    four,
+    eight
+};
+
+// Fills the 4-connected region of cells satisfying fillable that contains (row, col) with fill_value and returns
+// the number of filled cells. Whole row spans are filled at once and only one seed per span of the adjacent rows is
+// pushed, fill_value itself must not be fillable.
+template <typename T, std::predicate<const T&> Pred>
+constexpr size_t flood_fill(simple_mdarray<T>& m, const size_t row, const size_t col, Pred fillable, const T& fill_value)
+{
+    assert(!fillable(fill_value));
+
+    std::vector<std::pair<size_t, size_t>> seeds { { row, col } };
+    size_t num_filled = 0;
+
+    while (!seeds.empty()) {
+        const auto [r, c] = seeds.back();
+        seeds.pop_back();
+
+        if (!fillable(m[r, c]))
+            continue;
+
+        size_t left = c;
+        size_t right = c;
+
+        while (left > 0 && fillable(m[r, left - 1]))
+            --left;
+        while (right + 1 < m.cols() && fillable(m[r, right + 1]))
+            ++right;
+
+        for (size_t x = left; x <= right; ++x)
+            m[r, x] = fill_value;
+
+        num_filled += right - left + 1;
+
+        const auto push_spans = [&](const size_t adjacent_row) {
+            bool in_span = false;
+
+            for (size_t x = left; x <= right; ++x) {
+                const auto is_fillable = fillable(m[adjacent_row, x]);
+
+                if (is_fillable && !in_span)
+                    seeds.emplace_back(adjacent_row, x);
+
+                in_span = is_fillable;
+            }
+        };
+
+        if (r > 0)
+            push_spans(r - 1);
+        if (r + 1 < m.rows())
+            push_spans(r + 1);
+    }
+
+    return num_filled;
+}
+
+struct component_labels {
+    static constexpr uint32_t background = 0;
+
+    // labels are numbered 1..num_components in the raster order of the first cell of each component
+    simple_mdarray<uint32_t> labels;
+    size_t num_components = 0;
+};
+
+namespace detail {
+    class union_find {
+    public:
+        static constexpr auto none = std::numeric_limits<uint32_t>::max();
+
+        constexpr explicit union_find(const size_t size)
+            : parent_(size, none)
+        {
+        }
+
+        constexpr void add(const uint32_t i)
+        {
+            parent_[i] = i;
+        }
+
+        [[nodiscard]] constexpr bool contains(const uint32_t i) const
+        {
+            return parent_[i] != none;
+        }
+
+        // path halving, only to be used while no other thread touches the same trees
+        constexpr uint32_t find(uint32_t i)
+        {
+            while (parent_[i] != i) {
+                parent_[i] = parent_[parent_[i]];
+                i = parent_[i];
+            }
+            return i;
+        }
+
+        [[nodiscard]] constexpr uint32_t find_root(uint32_t i) const
+        {
+            while (parent_[i] != i)
+                i = parent_[i];
+            return i;
+        }
+
+        // the smaller index becomes the root, so each root is the first cell of its component in raster order
+        constexpr void unite(const uint32_t a, const uint32_t b)
+        {
+            const auto root_a = find(a);
+            const auto root_b = find(b);
+
+            if (root_a < root_b)
+                parent_[root_b] = root_a;
+            else if (root_b < root_a)
+                parent_[root_a] = root_b;
+        }
+
+    private:
+        std::vector<uint32_t> parent_;
+    };
+
+    // offsets (row, col) of the neighbors that precede a cell in raster order
+    inline constexpr auto preceding_offsets = std::to_array<std::pair<ptrdiff_t, ptrdiff_t>>({ { 0, -1 }, { -1, 0 }, { -1, -1 }, { -1, 1 } });
+
+    constexpr std::span<const std::pair<ptrdiff_t, ptrdiff_t>> preceding_neighbors(const adjacency adj)
+    {
+        const std::span offsets { preceding_offsets };
+
+        switch (adj) {
+        case adjacency::horizontal:
+            return offsets.first(1);
+        case adjacency::four:
+            return offsets.first(2);
+        case adjacency::eight:
+            return offsets;
+        }
+
+        std::unreachable();
+    }
+
+    struct row_band {
+        size_t first_row = 0;
+        size_t last_row = 0;
+        size_t num_roots = 0;
+        uint32_t first_label = 0;
+    };
+
+    constexpr std::vector<row_band> split_rows(const size_t rows, size_t num_bands)
+    {
+        num_bands = std::clamp<size_t>(num_bands, 1, std::max<size_t>(rows, 1));
+        const auto band_height = (rows + num_bands - 1) / num_bands;
+
+        return std::views::iota(size_t { 0 }, num_bands) | std::views::transform([=](const size_t band) {
+            return row_band { .first_row = std::min(band * band_height, rows), .last_row = std::min((band + 1) * band_height, rows) };
+        }) | std::ranges::to<std::vector>();
+    }
+
+    // one band of consecutive rows per hardware thread, a single band for sequential execution
+    template <typename ExecutionPolicy>
+    std::vector<row_band> split_rows(const size_t rows)
+    {
+        constexpr bool is_sequential = std::is_same_v<std::remove_cvref_t<ExecutionPolicy>, std::execution::sequenced_policy>;
+        return split_rows(rows, is_sequential ? 1 : std::thread::hardware_concurrency());
+    }
+
+    inline constexpr auto for_each_band_sequentially = [](std::vector<row_band>& bands, const auto& f) { std::ranges::for_each(bands, f); };
+
+    // The labeling behind label_components for a given split into bands, for_each_band(bands, f) calls f for every
+    // band and may do so concurrently. Each band is labeled on its own in the first pass, the components touching
+    // across the seams between consecutive bands are merged afterwards.
+    template <typename T, typename Pred, typename ForEachBand>
+    constexpr component_labels label_bands(const simple_mdarray<T>& m, Pred is_foreground, const adjacency adj,
+        std::vector<row_band> bands, ForEachBand for_each_band)
+    {
+        const auto rows = m.rows();
+        const auto cols = m.cols();
+
+        const auto index = [=](const size_t r, const size_t c) { return static_cast<uint32_t>(r * cols + c); };
+        const auto neighbors = preceding_neighbors(adj);
+
+        union_find sets(rows * cols);
+
+        // first pass: provisional labels, restricted to the rows of each band
+        for_each_band(bands, [&](const row_band& band) {
+            for (size_t r = band.first_row; r < band.last_row; ++r) {
+                for (size_t c = 0; c < cols; ++c) {
+                    if (!is_foreground(m[r, c]))
+                        continue;
+
+                    sets.add(index(r, c));
+
+                    for (const auto [d_r, d_c] : neighbors) {
+                        const auto n_r = static_cast<ptrdiff_t>(r) + d_r;
+                        const auto n_c = static_cast<ptrdiff_t>(c) + d_c;
+
+                        if (n_r < static_cast<ptrdiff_t>(band.first_row) || n_c < 0 || n_c >= static_cast<ptrdiff_t>(cols))
+                            continue;
+
+                        if (sets.contains(index(n_r, n_c)))
+                            sets.unite(index(r, c), index(n_r, n_c));
+                    }
+                }
+            }
+        });
+
+        // merge the components touching across the seams between consecutive bands
+        for (const auto& band : bands | std::views::drop(1)) {
+            const auto r = band.first_row;
+            if (r == 0 || r >= rows)
+                continue;
+
+            for (size_t c = 0; c < cols; ++c) {
+                if (!sets.contains(index(r, c)))
+                    continue;
+
+                for (const auto [d_r, d_c] : neighbors) {
+                    const auto n_c = static_cast<ptrdiff_t>(c) + d_c;
+
+                    if (d_r == 0 || n_c < 0 || n_c >= static_cast<ptrdiff_t>(cols))
+                        continue;
+
+                    if (sets.contains(index(r - 1, n_c)))
+                        sets.unite(index(r, c), index(r - 1, n_c));
+                }
+            }
+        }
+
+        // second pass: resolve the roots and number them consecutively in raster order
+        component_labels result { .labels = simple_mdarray<uint32_t>(rows, cols) };
+        auto labels = result.labels.data();
+
+        for_each_band(bands, [&](row_band& band) {
+            for (uint32_t i = index(band.first_row, 0); i < index(band.last_row, 0); ++i)
+                band.num_roots += sets.contains(i) && sets.find_root(i) == i;
+        });
+
+        uint32_t next_label = 1;
+        for (auto& band : bands) {
+            band.first_label = next_label;
+            next_label += static_cast<uint32_t>(band.num_roots);
+        }
+        result.num_components = next_label - 1;
+
+        for_each_band(bands, [&](const row_band& band) {
+            auto label = band.first_label;
+
+            for (uint32_t i = index(band.first_row, 0); i < index(band.last_row, 0); ++i) {
+                if (sets.contains(i) && sets.find_root(i) == i)
+                    labels[i] = label++;
+            }
+        });
+
+        // with the labels of all roots assigned, every other cell takes the label of its root
+        for_each_band(bands, [&](const row_band& band) {
+            for (uint32_t i = index(band.first_row, 0); i < index(band.last_row, 0); ++i) {
+                if (!sets.contains(i))
+                    continue;
+
+                if (const auto root = sets.find_root(i); root != i)
+                    labels[i] = labels[root];
+            }
+        });
+
+        return result;
+    }
+}
+
+// Two-pass connected component labeling of the cells satisfying is_foreground. With a parallel execution policy the
+// rows are split into bands that are labeled independently, the labels are merged across the band seams afterwards.
+template <typename ExecutionPolicy, typename T, std::predicate<const T&> Pred>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+component_labels label_components(ExecutionPolicy&& policy, const simple_mdarray<T>& m, Pred is_foreground,
+    const adjacency adj = adjacency::four)
+{
+    return detail::label_bands(m, std::move(is_foreground), adj, detail::split_rows<ExecutionPolicy>(m.rows()),
+        [&](std::vector<detail::row_band>& bands, const auto& f) { std::for_each(policy, bands.begin(), bands.end(), f); });
+}
+
+template <typename T, std::predicate<const T&> Pred>
+constexpr component_labels label_components(const simple_mdarray<T>& m, Pred is_foreground, const adjacency adj = adjacency::four)
+{
+    return detail::label_bands(m, std::move(is_foreground), adj, detail::split_rows(m.rows(), 1), detail::for_each_band_sequentially);
+}
+
+namespace detail {
+    constexpr simple_mdarray<char> grid_from_rows(const std::initializer_list<std::string_view> rows)
+    {
+        simple_mdarray<char> m(rows.size(), rows.begin()->size());
+
+        size_t r = 0;
+        for (const std::string_view row : rows) {
+            for (size_t c = 0; c < row.size(); ++c)
+                m[r, c] = row[c];
+            ++r;
+        }
+
+        return m;
+    }
+
+    // labeling the grid as a single band and with a seam between every two rows gives the same labels
+    constexpr bool labels_match_across_seams(const std::initializer_list<std::string_view> rows, const adjacency adj, const size_t num_components)
+    {
+        const auto m = grid_from_rows(rows);
+        const auto is_set = [](const char c) { return c == '#'; };
+
+        const auto single_band = label_bands(m, is_set, adj, split_rows(m.rows(), 1), for_each_band_sequentially);
+        const auto band_per_row = label_bands(m, is_set, adj, split_rows(m.rows(), m.rows()), for_each_band_sequentially);
+
+        return single_band.num_components == num_components && band_per_row.num_components == num_components
+            && std::ranges::equal(single_band.labels.data(), band_per_row.labels.data());
+    }
+
+    static_assert(labels_match_across_seams({ "##..#", "#..##", "..#..", "##.##" }, adjacency::horizontal, 7));
+    static_assert(labels_match_across_seams({ "##..#", "#..##", "..#..", "##.##" }, adjacency::four, 5));
+    static_assert(labels_match_across_seams({ "##..#", "#..##", "..#..", "##.##" }, adjacency::eight, 2));
+    // the two arms are only connected in the last row, i.e. after the last seam
+    static_assert(labels_match_across_seams({ "#.#", "#.#", "###" }, adjacency::four, 1));
+    static_assert(label_components(grid_from_rows({ "#.#", "#.#", "###" }), [](const char c) { return c == '#'; }).labels[0, 2] == 1);
+
+    static_assert([] {
+        auto m = grid_from_rows({ "#.#", "#.#", "###", "..#" });
+        return flood_fill(m, 0, 2, [](const char c) { return c == '#'; }, 'o') == 8 && m[0, 0] == 'o' && m[3, 2] == 'o';
+    }());
+}
+
+// Counts of the cells satisfying a predicate for whole rows and columns in O(1) and for rectangles in
+// O(log rows * log cols), backed by a two-dimensional Fenwick tree so that point updates take O(log rows * log cols)
+// as well.
+template <typename T, std::predicate<const T&> Pred>
+class prefix_index {
+public:
+    constexpr prefix_index(const simple_mdarray<T>& m, Pred pred)
+        : pred_(std::move(pred))
+        , matches_(m.rows(), m.cols())
+        , row_counts_(m.rows())
+        , col_counts_(m.cols())
+        , tree_(m.rows() + 1, m.cols() + 1)
+    {
+        for (size_t r = 0; r < m.rows(); ++r) {
+            for (size_t c = 0; c < m.cols(); ++c) {
+                const bool match = pred_(m[r, c]);
+                matches_[r, c] = match;
+                row_counts_[r] += match;
+                col_counts_[c] += match;
+                total_ += match;
+                tree_[r + 1, c + 1] = match;
+            }
+        }
+
+        // every node passes its sum on to its parent, first along the columns, then along the rows
+        for (size_t r = 1; r <= rows(); ++r) {
+            for (size_t c = 1; c <= cols(); ++c) {
+                if (const auto parent = c + lowest_bit(c); parent <= cols())
+                    tree_[r, parent] += tree_[r, c];
+            }
+        }
+
+        for (size_t r = 1; r <= rows(); ++r) {
+            if (const auto parent = r + lowest_bit(r); parent <= rows()) {
+                for (size_t c = 1; c <= cols(); ++c)
+                    tree_[parent, c] += tree_[r, c];
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr size_t rows() const
+    {
+        return matches_.rows();
+    }
+
+    [[nodiscard]] constexpr size_t cols() const
+    {
+        return matches_.cols();
+    }
+
+    [[nodiscard]] constexpr bool matches(const size_t row, const size_t col) const
+    {
+        return matches_[row, col];
+    }
+
+    [[nodiscard]] constexpr size_t row_count(const size_t row) const
+    {
+        return row_counts_[row];
+    }
+
+    [[nodiscard]] constexpr size_t col_count(const size_t col) const
+    {
+        return col_counts_[col];
+    }
+
+    [[nodiscard]] constexpr std::span<const size_t> row_counts() const
+    {
+        return row_counts_;
+    }
+
+    [[nodiscard]] constexpr std::span<const size_t> col_counts() const
+    {
+        return col_counts_;
+    }
+
+    [[nodiscard]] constexpr size_t total() const
+    {
+        return total_;
+    }
+
+    // number of matching cells in the rows [first_row, last_row) and the columns [first_col, last_col)
+    [[nodiscard]] constexpr size_t count(const size_t first_row, const size_t first_col, const size_t last_row, const size_t last_col) const
+    {
+        return prefix(last_row, last_col) + prefix(first_row, first_col) - prefix(first_row, last_col) - prefix(last_row, first_col);
+    }
+
+    // like count, but the rectangle is clipped to the grid
+    [[nodiscard]] constexpr size_t count_clipped(const ptrdiff_t first_row, const ptrdiff_t first_col, const ptrdiff_t last_row, const ptrdiff_t last_col) const
+    {
+        const auto clip = [](const ptrdiff_t v, const size_t max) { return static_cast<size_t>(std::clamp<ptrdiff_t>(v, 0, static_cast<ptrdiff_t>(max))); };
+        return count(clip(first_row, rows()), clip(first_col, cols()), clip(last_row, rows()), clip(last_col, cols()));
+    }
+
+    // sets the cell to value and updates all counts
+    constexpr void update(const size_t row, const size_t col, const T& value)
+    {
+        const bool match = pred_(value);
+        if (match == static_cast<bool>(matches_[row, col]))
+            return;
+
+        matches_[row, col] = match;
+
+        // size_t arithmetic wraps around, so adding the maximum value decrements
+        const size_t delta = match ? 1 : std::numeric_limits<size_t>::max();
+        row_counts_[row] += delta;
+        col_counts_[col] += delta;
+        total_ += delta;
+
+        for (size_t r = row + 1; r <= rows(); r += lowest_bit(r)) {
+            for (size_t c = col + 1; c <= cols(); c += lowest_bit(c))
+                tree_[r, c] += delta;
+        }
+    }
+
+private:
+    static constexpr size_t lowest_bit(const size_t i)
+    {
+        return i & (~i + 1);
+    }
+
+    // number of matching cells in the rows [0, row) and the columns [0, col)
+    [[nodiscard]] constexpr size_t prefix(const size_t row, const size_t col) const
+    {
+        size_t sum = 0;
+
+        for (size_t r = row; r > 0; r -= lowest_bit(r)) {
+            for (size_t c = col; c > 0; c -= lowest_bit(c))
+                sum += tree_[r, c];
+        }
+
+        return sum;
+    }
+
+    Pred pred_;
+    simple_mdarray<uint8_t> matches_;
+    std::vector<size_t> row_counts_;
+    std::vector<size_t> col_counts_;
+    size_t total_ = 0;
+    simple_mdarray<size_t> tree_;
+};
+
+namespace detail {
+    static_assert([] {
+        const auto is_set = [](const char c) { return c == '#'; };
+        prefix_index index(grid_from_rows({ "#..#.", ".##..", "#.###" }), is_set);
+
+        if (index.total() != 8 || index.count(0, 0, 3, 5) != 8 || index.count(1, 1, 3, 4) != 4 || index.count(0, 3, 2, 5) != 1)
+            return false;
+
+        if (index.count_clipped(-2, -2, 2, 2) != 2 || index.count_clipped(1, 3, 10, 10) != 2 || index.count_clipped(5, 0, 10, 5) != 0)
+            return false;
+
+        index.update(1, 3, '#');
+        index.update(2, 2, '.');
+        index.update(0, 0, '#');
+
+        return index.total() == 8 && index.count(1, 1, 3, 4) == 4 && index.count(0, 3, 2, 5) == 2 && index.count(2, 0, 3, 5) == 3
+            && index.row_count(1) == 3 && index.col_count(2) == 1;
+    }());
+}
+
+struct stencil_offset {
+    ptrdiff_t row = 0;
+    ptrdiff_t col = 0;
+};
+
+// the 8 cells around a cell
+inline constexpr auto moore_neighborhood = std::to_array<stencil_offset>({ { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 } });
+
+// the 4 cells sharing an edge with a cell
+inline constexpr auto von_neumann_neighborhood = std::to_array<stencil_offset>({ { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 } });
+
+namespace detail {
+    struct stencil_extent {
+        ptrdiff_t min_row = 0;
+        ptrdiff_t max_row = 0;
+        ptrdiff_t min_col = 0;
+        ptrdiff_t max_col = 0;
+    };
+
+    template <size_t N>
+    constexpr stencil_extent extent_of(const std::array<stencil_offset, N>& offsets)
+    {
+        stencil_extent extent;
+
+        for (const auto [row, col] : offsets) {
+            extent.min_row = std::min(extent.min_row, row);
+            extent.max_row = std::max(extent.max_row, row);
+            extent.min_col = std::min(extent.min_col, col);
+            extent.max_col = std::max(extent.max_col, col);
+        }
+
+        return extent;
+    }
+
+    // the range [first, last) of positions along an axis of the given size whose stencil stays inside the grid
+    constexpr std::pair<size_t, size_t> interior_range(const size_t size, const ptrdiff_t min_offset, const ptrdiff_t max_offset)
+    {
+        const auto first = std::min(static_cast<size_t>(-min_offset), size);
+        const auto last = std::max(first, size - std::min(static_cast<size_t>(max_offset), size));
+        return { first, last };
+    }
+}
+
+// Evaluates combine(m[row, col], neighbors) for every cell, where neighbors holds the values at the Offsets relative to
+// the cell in their order and outside for offsets leaving the grid. Cells whose whole stencil lies inside the grid
+// gather their neighbors without bounds checks from fixed linear offsets in an unrolled loop, only the cells along the
+// border take the checked path. With a parallel policy the rows are processed in bands.
+template <auto Offsets, typename ExecutionPolicy, typename T, typename Combine>
+    requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>>
+auto apply_stencil(ExecutionPolicy&& policy, const simple_mdarray<T>& m, Combine combine, const T& outside = T {})
+{
+    constexpr auto num_offsets = Offsets.size();
+    constexpr auto extent = detail::extent_of(Offsets);
+
+    using neighbors = std::array<T, num_offsets>;
+    using result_type = std::remove_cvref_t<std::invoke_result_t<Combine&, const T&, const neighbors&>>;
+
+    const auto rows = m.rows();
+    const auto cols = m.cols();
+
+    simple_mdarray<result_type> result(rows, cols);
+
+    const auto [interior_first_row, interior_last_row] = detail::interior_range(rows, extent.min_row, extent.max_row);
+    const auto [interior_first_col, interior_last_col] = detail::interior_range(cols, extent.min_col, extent.max_col);
+
+    std::array<ptrdiff_t, num_offsets> linear_offsets {};
+    for (size_t i = 0; i < num_offsets; ++i)
+        linear_offsets[i] = Offsets[i].row * static_cast<ptrdiff_t>(cols) + Offsets[i].col;
+
+    const auto border_cell = [&](const size_t row, const size_t col) {
+        neighbors values;
+
+        for (size_t i = 0; i < num_offsets; ++i) {
+            const auto n_r = static_cast<ptrdiff_t>(row) + Offsets[i].row;
+            const auto n_c = static_cast<ptrdiff_t>(col) + Offsets[i].col;
+            const bool inside = n_r >= 0 && n_c >= 0 && n_r < static_cast<ptrdiff_t>(rows) && n_c < static_cast<ptrdiff_t>(cols);
+
+            values[i] = inside ? m[static_cast<size_t>(n_r), static_cast<size_t>(n_c)] : outside;
+        }
+
+        return combine(m[row, col], values);
+    };
+
+    const auto interior_cell = [&]<size_t... I>(const T* center, std::index_sequence<I...>) {
+        return combine(*center, neighbors { center[linear_offsets[I]]... });
+    };
+
+    auto bands = detail::split_rows<ExecutionPolicy>(rows);
+
+    std::for_each(policy, bands.begin(), bands.end(), [&](const detail::row_band& band) {
+        for (size_t row = band.first_row; row < band.last_row; ++row) {
+            if (row < interior_first_row || row >= interior_last_row) {
+                for (size_t col = 0; col < cols; ++col)
+                    result[row, col] = border_cell(row, col);
+                continue;
+            }
+
+            for (size_t col = 0; col < interior_first_col; ++col)
+                result[row, col] = border_cell(row, col);
+
+            const T* row_data = m.data().data() + row * cols;
+            for (size_t col = interior_first_col; col < interior_last_col; ++col)
+                result[row, col] = interior_cell(row_data + col, std::make_index_sequence<num_offsets> {});
+
+            for (size_t col = interior_last_col; col < cols; ++col)
+                result[row, col] = border_cell(row, col);
+        }
+    });
+
+    return result;
+}
+
+template <auto Offsets, typename T, typename Combine>
+auto apply_stencil(const simple_mdarray<T>& m, Combine combine, const T& outside = T {})
+{
+    return apply_stencil<Offsets>(std::execution::seq, m, std::move(combine), outside);
+}
+}
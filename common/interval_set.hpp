@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aoc {
+
+// A set of integers given as closed intervals [first, last]. The intervals are kept sorted, disjoint and non-adjacent,
+// so membership is a binary search and the size of the set is the sum of the interval lengths.
+template <std::integral T>
+class interval_set {
+public:
+    using interval = std::pair<T, T>;
+
+    interval_set() = default;
+
+    explicit interval_set(std::vector<interval> intervals)
+        : intervals_(std::move(intervals))
+    {
+        if (std::ranges::any_of(intervals_, [](const interval& i) { return i.first > i.second; }))
+            throw std::invalid_argument("interval must not end before it starts");
+
+        std::ranges::sort(intervals_);
+
+        size_t num_merged = 0;
+        for (const auto& i : intervals_) {
+            // overlapping or adjacent intervals are merged, the second check only runs if last is not the maximum
+            if (num_merged > 0 && (i.first <= intervals_[num_merged - 1].second || i.first == intervals_[num_merged - 1].second + 1))
+                intervals_[num_merged - 1].second = std::max(intervals_[num_merged - 1].second, i.second);
+            else
+                intervals_[num_merged++] = i;
+        }
+
+        intervals_.resize(num_merged);
+    }
+
+    [[nodiscard]] std::span<const interval> intervals() const
+    {
+        return intervals_;
+    }
+
+    [[nodiscard]] bool contains(const T value) const
+    {
+        // the last interval starting at or before value is the only candidate
+        const auto it = std::ranges::upper_bound(intervals_, value, {}, &interval::first);
+        return it != intervals_.begin() && value <= std::prev(it)->second;
+    }
+
+    // number of the values contained in the set, the values have to be sorted so that both can be merged in one pass
+    [[nodiscard]] size_t count_contained(const std::span<const T> sorted_values) const
+    {
+        assert(std::ranges::is_sorted(sorted_values));
+
+        size_t count = 0;
+        auto it = intervals_.begin();
+
+        for (const auto value : sorted_values) {
+            while (it != intervals_.end() && it->second < value)
+                ++it;
+
+            if (it == intervals_.end())
+                break;
+
+            count += it->first <= value;
+        }
+
+        return count;
+    }
+
+    // number of integers in the set
+    [[nodiscard]] size_t coverage() const
+    {
+        using unsigned_type = std::make_unsigned_t<T>;
+
+        size_t sum = 0;
+        for (const auto& [first, last] : intervals_)
+            sum += static_cast<size_t>(static_cast<unsigned_type>(last) - static_cast<unsigned_type>(first)) + 1;
+
+        return sum;
+    }
+
+private:
+    std::vector<interval> intervals_;
+};
+
+template <std::integral T>
+interval_set(std::vector<std::pair<T, T>>) -> interval_set<T>;
+}
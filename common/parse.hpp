@@ -0,0 +1,359 @@
+#pragma once
+
+#include <util.hpp>
+
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Small parser combinators working on std::string_view without any heap allocation. A parser consumes a prefix of
+// the input on success and leaves the input untouched on failure.
+namespace aoc::parse {
+
+// value of parsers whose result is dropped from sequences
+struct skip {
+};
+
+template <typename P>
+concept parser = requires(const P& p, std::string_view& in) {
+    typename P::value_type;
+    {
+        p(in)
+    } -> std::same_as<std::optional<typename P::value_type>>;
+};
+
+struct literal {
+    using value_type = skip;
+
+    std::string_view text;
+
+    constexpr std::optional<skip> operator()(std::string_view& in) const
+    {
+        if (!in.starts_with(text))
+            return std::nullopt;
+
+        in.remove_prefix(text.size());
+        return skip {};
+    }
+};
+
+// a single character out of a set
+struct one_of_chars {
+    using value_type = skip;
+
+    std::string_view chars;
+
+    constexpr std::optional<skip> operator()(std::string_view& in) const
+    {
+        if (in.empty() || chars.find(in.front()) == std::string_view::npos)
+            return std::nullopt;
+
+        in.remove_prefix(1);
+        return skip {};
+    }
+};
+
+// zero or more spaces
+struct spaces {
+    using value_type = skip;
+
+    constexpr std::optional<skip> operator()(std::string_view& in) const
+    {
+        in.remove_prefix(std::min(in.find_first_not_of(' '), in.size()));
+        return skip {};
+    }
+};
+
+template <std::integral T>
+struct integer {
+    using value_type = T;
+
+    constexpr std::optional<T> operator()(std::string_view& in) const
+    {
+        T value {};
+        const auto [end, ec] = std::from_chars(in.data(), in.data() + in.size(), value);
+
+        if (ec != std::errc {})
+            return std::nullopt;
+
+        in.remove_prefix(static_cast<size_t>(end - in.data()));
+        return value;
+    }
+};
+
+template <std::unsigned_integral T = size_t>
+inline constexpr integer<T> unsigned_number {};
+
+template <std::signed_integral T = int64_t>
+inline constexpr integer<T> signed_number {};
+
+// a non-empty run of letters, digits and underscores
+struct identifier {
+    using value_type = std::string_view;
+
+    constexpr std::optional<std::string_view> operator()(std::string_view& in) const
+    {
+        constexpr auto is_identifier_char = [](const char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || is_digit(c) || c == '_';
+        };
+
+        const auto length = static_cast<size_t>(std::ranges::distance(in.begin(), std::ranges::find_if_not(in, is_identifier_char)));
+        if (length == 0)
+            return std::nullopt;
+
+        const auto result = in.substr(0, length);
+        in.remove_prefix(length);
+        return result;
+    }
+};
+
+// an identifier out of a fixed set of names, interned to the enumerator with the index of the name
+template <typename Enum, size_t N>
+    requires std::is_enum_v<Enum>
+struct keyword {
+    using value_type = Enum;
+
+    std::array<std::string_view, N> names;
+
+    constexpr std::optional<Enum> operator()(std::string_view& in) const
+    {
+        auto rest = in;
+        const auto name = identifier {}(rest);
+        if (!name)
+            return std::nullopt;
+
+        const auto it = std::ranges::find(names, *name);
+        if (it == names.end())
+            return std::nullopt;
+
+        in = rest;
+        return static_cast<Enum>(std::ranges::distance(names.begin(), it));
+    }
+};
+
+template <typename Enum, size_t N>
+constexpr keyword<Enum, N> keywords(const std::array<std::string_view, N>& names)
+{
+    return { names };
+}
+
+namespace detail {
+    constexpr literal as_parser(const std::string_view text)
+    {
+        return { text };
+    }
+
+    template <parser P>
+    constexpr const P& as_parser(const P& p)
+    {
+        return p;
+    }
+
+    template <typename T>
+    using kept_t = std::conditional_t<std::is_same_v<T, skip>, std::tuple<>, std::tuple<T>>;
+
+    template <typename T>
+    constexpr kept_t<T> keep(T&& value)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<T>, skip>)
+            return {};
+        else
+            return kept_t<T> { std::forward<T>(value) };
+    }
+}
+
+// all parsers in order, the values of the non-skip parsers are collected in a tuple
+template <parser... Ps>
+struct sequence {
+    using value_type = decltype(std::tuple_cat(std::declval<detail::kept_t<typename Ps::value_type>>()...));
+
+    std::tuple<Ps...> parsers;
+
+    constexpr std::optional<value_type> operator()(std::string_view& in) const
+    {
+        const auto start = in;
+
+        return [&]<size_t... I>(std::index_sequence<I...>) -> std::optional<value_type> {
+            std::tuple<std::optional<typename Ps::value_type>...> parts;
+
+            if (!((std::get<I>(parts) = std::get<I>(parsers)(in)).has_value() && ...)) {
+                in = start;
+                return std::nullopt;
+            }
+
+            return std::tuple_cat(detail::keep(std::move(*std::get<I>(parts)))...);
+        }(std::index_sequence_for<Ps...> {});
+    }
+};
+
+// string literals can be used directly as literal parsers
+template <typename... Ps>
+constexpr auto seq(const Ps&... ps)
+{
+    return sequence<std::remove_cvref_t<decltype(detail::as_parser(ps))>...> { { detail::as_parser(ps)... } };
+}
+
+template <parser P, typename F>
+struct transformed {
+    using value_type = std::remove_cvref_t<std::invoke_result_t<const F&, typename P::value_type>>;
+
+    P p;
+    F f;
+
+    constexpr std::optional<value_type> operator()(std::string_view& in) const
+    {
+        if (auto value = p(in))
+            return std::invoke(f, std::move(*value));
+
+        return std::nullopt;
+    }
+};
+
+template <parser P, typename F>
+constexpr transformed<P, F> transform(P p, F f)
+{
+    return { std::move(p), std::move(f) };
+}
+
+// builds an aggregate from the tuple produced by a sequence
+template <typename T, parser P>
+constexpr auto into(P p)
+{
+    return transform(std::move(p), [](auto&& values) {
+        return std::apply([](auto&&... v) { return T { std::forward<decltype(v)>(v)... }; }, std::forward<decltype(values)>(values));
+    });
+}
+
+template <typename T, size_t N>
+struct fixed_list {
+    std::array<T, N> items {};
+    size_t count = 0;
+
+    constexpr auto begin() const { return items.begin(); }
+    constexpr auto end() const { return items.begin() + count; }
+    constexpr size_t size() const { return count; }
+    constexpr const T& operator[](const size_t i) const { return items[i]; }
+};
+
+// one or more items separated by sep, at most N of them
+template <size_t N, parser P, parser Sep>
+struct separated_list {
+    using value_type = fixed_list<typename P::value_type, N>;
+
+    P item;
+    Sep sep;
+
+    constexpr std::optional<value_type> operator()(std::string_view& in) const
+    {
+        const auto start = in;
+        value_type result;
+
+        do {
+            auto value = item(in);
+            if (!value || result.count == N) {
+                in = start;
+                return std::nullopt;
+            }
+
+            result.items[result.count++] = std::move(*value);
+        } while (continue_list(in));
+
+        return result;
+    }
+
+private:
+    constexpr bool continue_list(std::string_view& in) const
+    {
+        auto rest = in;
+        if (!sep(rest))
+            return false;
+
+        auto lookahead = rest;
+        if (!item(lookahead))
+            return false;
+
+        in = rest;
+        return true;
+    }
+};
+
+template <size_t N, parser P, typename Sep>
+constexpr auto separated(P item, const Sep& sep)
+{
+    return separated_list<N, P, std::remove_cvref_t<decltype(detail::as_parser(sep))>> { std::move(item), detail::as_parser(sep) };
+}
+
+// one or more items separated by sep, folded into a single value as they are parsed, so the number of items is not
+// bounded
+template <parser P, parser Sep, typename Acc, typename Op>
+struct folded_list {
+    using value_type = Acc;
+
+    P item;
+    Sep sep;
+    Acc init;
+    Op op;
+
+    constexpr std::optional<Acc> operator()(std::string_view& in) const
+    {
+        const auto start = in;
+
+        auto value = item(in);
+        if (!value) {
+            in = start;
+            return std::nullopt;
+        }
+
+        Acc acc = std::invoke(op, init, std::move(*value));
+
+        while (true) {
+            auto rest = in;
+            if (!sep(rest))
+                break;
+
+            auto next = item(rest);
+            if (!next)
+                break;
+
+            acc = std::invoke(op, std::move(acc), std::move(*next));
+            in = rest;
+        }
+
+        return acc;
+    }
+};
+
+template <parser P, typename Sep, typename Acc, typename Op>
+constexpr auto fold_separated(P item, const Sep& sep, Acc init, Op op)
+{
+    return folded_list<P, std::remove_cvref_t<decltype(detail::as_parser(sep))>, Acc, Op> { std::move(item), detail::as_parser(sep), std::move(init), std::move(op) };
+}
+
+// parses the whole input, fails if anything is left
+template <parser P>
+constexpr std::optional<typename P::value_type> parse_all(const P& p, std::string_view in)
+{
+    auto value = p(in);
+    if (!value || !in.empty())
+        return std::nullopt;
+
+    return value;
+}
+
+// like parse_all, but treats failure as malformed input
+template <parser P>
+constexpr typename P::value_type parse_line(const P& p, const std::string_view line)
+{
+    auto value = parse_all(p, line);
+    if (!value)
+        throw std::invalid_argument("malformed line");
+
+    return std::move(*value);
+}
+}
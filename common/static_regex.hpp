@@ -0,0 +1,490 @@
+#pragma once
+
+#include <util.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+// Regular expressions compiled at compile time, for the subset of the syntax used in the puzzles: literals, '.',
+// the classes \d \w \s, bracket expressions with ranges and negation, the quantifiers ? * + {n} {n,m} on single
+// atoms and non-quantified capture groups. Anything else, like alternation, anchors or quantified groups, fails to
+// compile. Matching works on string_views and captures are views into the input.
+// The pattern is compiled into its position automaton, with one position per character an atom can consume (a
+// repeat {n,m} takes m positions, at most 64 in total), and matched by tracking the set of active positions as a
+// bit mask without any backtracking. For a text of length n and a pattern of m positions match_prefix takes
+// O(n * m) and search O(n * m^2) time. Matches are leftmost-longest, the captures are resolved in a second pass
+// over the matched characters in which earlier atoms take as many characters as possible.
+namespace aoc {
+
+template <size_t N>
+struct fixed_string {
+    char chars[N] {};
+
+    consteval fixed_string(const char (&str)[N])
+    {
+        std::ranges::copy(str, chars);
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const
+    {
+        return { chars, N - 1 };
+    }
+};
+
+namespace detail {
+    struct char_set {
+        std::array<uint64_t, 4> bits {};
+
+        constexpr void insert(const unsigned char c)
+        {
+            bits[c / 64] |= uint64_t { 1 } << (c % 64);
+        }
+
+        constexpr void insert_range(const unsigned char first, const unsigned char last)
+        {
+            for (unsigned c = first; c <= last; ++c)
+                insert(static_cast<unsigned char>(c));
+        }
+
+        constexpr void insert(const char_set& other)
+        {
+            for (size_t i = 0; i < bits.size(); ++i)
+                bits[i] |= other.bits[i];
+        }
+
+        constexpr void invert()
+        {
+            for (auto& b : bits)
+                b = ~b;
+        }
+
+        [[nodiscard]] constexpr bool contains(const char c) const
+        {
+            const auto u = static_cast<unsigned char>(c);
+            return (bits[u / 64] >> (u % 64)) & 1;
+        }
+
+        [[nodiscard]] constexpr std::optional<char> single_char() const
+        {
+            std::optional<char> result;
+
+            for (unsigned c = 0; c < 256; ++c) {
+                if (!contains(static_cast<char>(c)))
+                    continue;
+                if (result)
+                    return std::nullopt;
+                result = static_cast<char>(c);
+            }
+
+            return result;
+        }
+    };
+
+    struct regex_atom {
+        static constexpr auto unbounded = std::numeric_limits<size_t>::max();
+
+        char_set chars;
+        size_t min = 1;
+        size_t max = 1;
+    };
+
+    inline constexpr size_t max_regex_positions = 64;
+
+    constexpr uint64_t position_bit(const size_t position)
+    {
+        return uint64_t { 1 } << position;
+    }
+
+    template <size_t MaxAtoms>
+    struct regex_program {
+        std::array<regex_atom, MaxAtoms> atoms {};
+        size_t num_atoms = 0;
+        // capture group i spans the atoms [first, last)
+        std::array<std::pair<size_t, size_t>, MaxAtoms> groups {};
+        size_t num_groups = 0;
+
+        // position automaton, sets of positions are bit masks
+        std::array<size_t, max_regex_positions> position_atom {};
+        size_t num_positions = 0;
+        // positions that can consume the first character
+        uint64_t initial = 0;
+        // positions that can consume the character after one consumed by position i
+        std::array<uint64_t, max_regex_positions> follow {};
+        // positions i with position j in follow[i]
+        std::array<uint64_t, max_regex_positions> preceding {};
+        // positions after which the pattern may end
+        uint64_t accepting = 0;
+        bool accepts_empty = true;
+        // positions that can consume character c
+        std::array<uint64_t, 256> char_masks {};
+    };
+
+    constexpr char_set escape_class(const char c)
+    {
+        char_set set;
+
+        switch (c) {
+        case 'd':
+            set.insert_range('0', '9');
+            break;
+        case 'w':
+            set.insert_range('a', 'z');
+            set.insert_range('A', 'Z');
+            set.insert_range('0', '9');
+            set.insert('_');
+            break;
+        case 's':
+            for (const char ws : std::string_view { " \t\n\r\f\v" })
+                set.insert(static_cast<unsigned char>(ws));
+            break;
+        default:
+            set.insert(static_cast<unsigned char>(c));
+        }
+
+        return set;
+    }
+
+    template <size_t MaxAtoms>
+    consteval regex_program<MaxAtoms> compile_regex(const std::string_view pattern)
+    {
+        regex_program<MaxAtoms> program;
+        std::array<size_t, MaxAtoms> open_groups {};
+        size_t num_open_groups = 0;
+
+        const auto parse_count = [&](size_t& i) {
+            size_t value = 0;
+            if (i >= pattern.size() || !is_digit(pattern[i]))
+                throw std::invalid_argument("expected repeat count");
+            while (i < pattern.size() && is_digit(pattern[i]))
+                value = value * 10 + static_cast<size_t>(pattern[i++] - '0');
+            return value;
+        };
+
+        const auto is_quantifier = [](const char c) { return c == '?' || c == '*' || c == '+' || c == '{'; };
+
+        size_t i = 0;
+        while (i < pattern.size()) {
+            const char c = pattern[i++];
+
+            if (c == '|' || c == '^' || c == '$')
+                throw std::invalid_argument("alternation and anchors are not supported");
+
+            if (is_quantifier(c))
+                throw std::invalid_argument("quantifier without preceding atom");
+
+            if (c == '(') {
+                open_groups[num_open_groups++] = program.num_groups;
+                program.groups[program.num_groups++] = { program.num_atoms, program.num_atoms };
+                continue;
+            }
+
+            if (c == ')') {
+                if (num_open_groups == 0)
+                    throw std::invalid_argument("unbalanced ')'");
+                program.groups[open_groups[--num_open_groups]].second = program.num_atoms;
+                if (i < pattern.size() && is_quantifier(pattern[i]))
+                    throw std::invalid_argument("quantified groups are not supported");
+                continue;
+            }
+
+            regex_atom atom;
+
+            if (c == '\\') {
+                if (i >= pattern.size())
+                    throw std::invalid_argument("dangling escape");
+                atom.chars = escape_class(pattern[i++]);
+            } else if (c == '.') {
+                atom.chars.insert('\n');
+                atom.chars.invert();
+            } else if (c == '[') {
+                const bool negate = i < pattern.size() && pattern[i] == '^';
+                i += negate;
+
+                while (i < pattern.size() && pattern[i] != ']') {
+                    if (pattern[i] == '\\' && i + 1 < pattern.size()) {
+                        atom.chars.insert(escape_class(pattern[i + 1]));
+                        i += 2;
+                    } else if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']') {
+                        atom.chars.insert_range(static_cast<unsigned char>(pattern[i]), static_cast<unsigned char>(pattern[i + 2]));
+                        i += 3;
+                    } else {
+                        atom.chars.insert(static_cast<unsigned char>(pattern[i++]));
+                    }
+                }
+
+                if (i++ >= pattern.size())
+                    throw std::invalid_argument("unterminated '['");
+                if (negate)
+                    atom.chars.invert();
+            } else {
+                atom.chars.insert(static_cast<unsigned char>(c));
+            }
+
+            if (i < pattern.size()) {
+                switch (pattern[i]) {
+                case '?':
+                    atom.min = 0;
+                    atom.max = 1;
+                    ++i;
+                    break;
+                case '*':
+                    atom.min = 0;
+                    atom.max = regex_atom::unbounded;
+                    ++i;
+                    break;
+                case '+':
+                    atom.min = 1;
+                    atom.max = regex_atom::unbounded;
+                    ++i;
+                    break;
+                case '{':
+                    ++i;
+                    atom.min = parse_count(i);
+                    atom.max = atom.min;
+                    if (i < pattern.size() && pattern[i] == ',') {
+                        ++i;
+                        atom.max = parse_count(i);
+                    }
+                    if (i >= pattern.size() || pattern[i++] != '}' || atom.max < atom.min)
+                        throw std::invalid_argument("malformed repeat");
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            program.atoms[program.num_atoms++] = atom;
+        }
+
+        if (num_open_groups != 0)
+            throw std::invalid_argument("unbalanced '('");
+
+        // each atom takes one mandatory position per required repetition and one optional position per further
+        // one, unbounded repeats loop on their last position
+        std::array<bool, max_regex_positions> mandatory {};
+        std::array<bool, max_regex_positions> loops {};
+
+        const auto add_position = [&](const size_t atom, const bool is_mandatory, const bool is_loop) {
+            if (program.num_positions == max_regex_positions)
+                throw std::invalid_argument("pattern has too many positions");
+
+            program.position_atom[program.num_positions] = atom;
+            mandatory[program.num_positions] = is_mandatory;
+            loops[program.num_positions] = is_loop;
+            ++program.num_positions;
+        };
+
+        for (size_t a = 0; a < program.num_atoms; ++a) {
+            const auto& atom = program.atoms[a];
+            const bool unbounded = atom.max == regex_atom::unbounded;
+
+            for (size_t k = 0; k < atom.min; ++k)
+                add_position(a, true, unbounded && k + 1 == atom.min);
+
+            if (unbounded && atom.min == 0)
+                add_position(a, false, true);
+            else if (!unbounded)
+                for (size_t k = atom.min; k < atom.max; ++k)
+                    add_position(a, false, false);
+        }
+
+        // positions up to and including the first mandatory one from first on
+        const auto reachable_from = [&](const size_t first) {
+            uint64_t positions = 0;
+            for (size_t j = first; j < program.num_positions; ++j) {
+                positions |= position_bit(j);
+                if (mandatory[j])
+                    break;
+            }
+            return positions;
+        };
+
+        const auto only_optional_from = [&](const size_t first) {
+            return std::ranges::none_of(mandatory.begin() + first, mandatory.begin() + program.num_positions, std::identity {});
+        };
+
+        program.initial = reachable_from(0);
+        program.accepts_empty = only_optional_from(0);
+
+        for (size_t i = 0; i < program.num_positions; ++i) {
+            program.follow[i] = reachable_from(i + 1) | (loops[i] ? position_bit(i) : 0);
+
+            if (only_optional_from(i + 1))
+                program.accepting |= position_bit(i);
+
+            for (unsigned c = 0; c < 256; ++c) {
+                if (program.atoms[program.position_atom[i]].chars.contains(static_cast<char>(c)))
+                    program.char_masks[c] |= position_bit(i);
+            }
+        }
+
+        for (size_t i = 0; i < program.num_positions; ++i) {
+            for (size_t j = 0; j < program.num_positions; ++j) {
+                if (program.follow[i] & position_bit(j))
+                    program.preceding[j] |= position_bit(i);
+            }
+        }
+
+        return program;
+    }
+}
+
+template <fixed_string Pattern>
+class static_regex {
+    static constexpr auto program = detail::compile_regex<Pattern.view().size()>(Pattern.view());
+
+public:
+    static constexpr size_t num_groups = program.num_groups;
+
+    // element 0 is the whole match, element i the i-th capture group
+    using match = std::array<std::string_view, num_groups + 1>;
+
+    // the longest match starting at the beginning of text
+    [[nodiscard]] static constexpr std::optional<match> match_prefix(const std::string_view text)
+    {
+        // active positions after each consumed character, kept for resolving the captures
+        std::vector<uint64_t> active_positions;
+        std::optional<size_t> end;
+
+        if (program.accepts_empty)
+            end = 0;
+
+        uint64_t active = 0;
+        for (size_t k = 0; k < text.size(); ++k) {
+            active = step(active, k == 0, text[k]);
+            if (active == 0)
+                break;
+
+            active_positions.push_back(active);
+            if (active & program.accepting)
+                end = k + 1;
+        }
+
+        if (!end)
+            return std::nullopt;
+
+        return resolve_captures(text.substr(0, *end), active_positions);
+    }
+
+    // the leftmost-longest match in text
+    [[nodiscard]] static constexpr std::optional<match> search(const std::string_view text)
+    {
+        if constexpr (program.accepts_empty) {
+            return match_prefix(text);
+        } else {
+            // earliest start of the threads in each active position
+            std::array<size_t, detail::max_regex_positions> starts {};
+            std::array<size_t, detail::max_regex_positions> next_starts {};
+            uint64_t active = 0;
+            std::optional<size_t> match_start;
+
+            for (size_t k = 0; k < text.size(); ++k) {
+                if (active == 0) {
+                    if (match_start)
+                        break;
+
+                    // skip ahead to the first character of the pattern if it is a mandatory literal
+                    if constexpr (first_char) {
+                        k = text.find(*first_char, k);
+                        if (k == std::string_view::npos)
+                            return std::nullopt;
+                    }
+                }
+
+                const auto consumable = program.char_masks[static_cast<unsigned char>(text[k])];
+                uint64_t next = 0;
+
+                const auto advance = [&](uint64_t targets, const size_t start) {
+                    for (; targets != 0; targets &= targets - 1) {
+                        const auto p = std::countr_zero(targets);
+                        if (!(next & detail::position_bit(p)) || start < next_starts[p])
+                            next_starts[p] = start;
+                        next |= detail::position_bit(p);
+                    }
+                };
+
+                for (auto q = active; q != 0; q &= q - 1) {
+                    const auto i = std::countr_zero(q);
+                    advance(program.follow[i] & consumable, starts[i]);
+                }
+
+                // once a match is found no thread starting later can be leftmost
+                if (!match_start)
+                    advance(program.initial & consumable, k);
+
+                for (auto q = next & program.accepting; q != 0; q &= q - 1)
+                    match_start = std::min(match_start.value_or(k), next_starts[std::countr_zero(q)]);
+
+                starts = next_starts;
+                active = 0;
+                for (auto q = next; q != 0; q &= q - 1) {
+                    if (!match_start || starts[std::countr_zero(q)] < *match_start)
+                        active |= detail::position_bit(std::countr_zero(q));
+                }
+            }
+
+            if (!match_start)
+                return std::nullopt;
+
+            return match_prefix(text.substr(*match_start));
+        }
+    }
+
+private:
+    static constexpr std::optional<char> first_char = program.num_atoms > 0 && program.atoms[0].min > 0
+        ? program.atoms[0].chars.single_char()
+        : std::nullopt;
+
+    // positions reached from the active positions by consuming c, from_start for the first character of a match
+    static constexpr uint64_t step(uint64_t active, const bool from_start, const char c)
+    {
+        uint64_t next = from_start ? program.initial : 0;
+
+        for (; active != 0; active &= active - 1)
+            next |= program.follow[std::countr_zero(active)];
+
+        return next & program.char_masks[static_cast<unsigned char>(c)];
+    }
+
+    // assigns each character of the match to one of the positions active when it was consumed, walking backwards
+    // from an accepting position and preferring the lowest position, i.e. the earliest atom, at each step
+    static constexpr match resolve_captures(const std::string_view span, const std::span<const uint64_t> active_positions)
+    {
+        // bounds[i] receives the offset at which atom i starts matching
+        std::array<size_t, program.num_atoms + 1> bounds {};
+
+        uint64_t candidates = program.accepting;
+        for (size_t k = span.size(); k-- > 0;) {
+            const auto feasible = active_positions[k] & candidates;
+            assert(feasible != 0);
+
+            const auto p = std::countr_zero(feasible);
+            ++bounds[program.position_atom[p] + 1];
+            candidates = program.preceding[p];
+        }
+
+        for (size_t a = 1; a < bounds.size(); ++a)
+            bounds[a] += bounds[a - 1];
+
+        match m;
+        m[0] = span;
+
+        for (size_t g = 0; g < num_groups; ++g) {
+            const auto [first, last] = program.groups[g];
+            m[g + 1] = span.substr(bounds[first], bounds[last] - bounds[first]);
+        }
+
+        return m;
+    }
+};
+}
@@ -7,6 +7,9 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <ranges>
 #include <source_location>
 #include <sstream>
@@ -41,6 +44,170 @@ constexpr auto to_int(const std::string_view s)
     return r;
 }
 
+// the indices 0..n-1 as a vector, for running the parallel algorithms over an index range: iota_view iterators are
+// no Cpp17 random access iterators, so the parallel algorithms would fall back to serial execution on them
+inline std::vector<size_t> index_vector(const size_t n)
+{
+    std::vector<size_t> indices(n);
+    std::iota(indices.begin(), indices.end(), size_t { 0 });
+    return indices;
+}
+
+struct aho_match {
+    size_t pattern = 0;
+    size_t position = 0;
+
+    friend constexpr bool operator==(const aho_match&, const aho_match&) = default;
+};
+
+template <size_t NumPatterns>
+constexpr size_t num_trie_states(const std::array<std::string_view, NumPatterns>& patterns)
+{
+    return std::ranges::fold_left(patterns | std::views::transform(&std::string_view::size), size_t { 1 }, std::plus {});
+}
+
+// Aho-Corasick automaton over bytes with a flat transition table, buildable at compile time. It is built once for the
+// patterns and once for the reversed patterns, the latter allows finding the last match by scanning backwards.
+template <size_t NumPatterns, size_t NumStates>
+    requires(NumStates <= std::numeric_limits<uint16_t>::max())
+class aho_corasick {
+public:
+    constexpr explicit aho_corasick(const std::array<std::string_view, NumPatterns>& patterns)
+    {
+        for (size_t i = 0; i < NumPatterns; ++i)
+            lengths_[i] = patterns[i].size();
+
+        forward_.build(patterns, false);
+        backward_.build(patterns, true);
+    }
+
+    // reports all matches ordered by their end, for equal ends the longest pattern first
+    constexpr void scan(const std::string_view text, std::invocable<aho_match> auto&& on_match) const
+    {
+        uint16_t state = 0;
+
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = forward_.advance(state, text[i]);
+            forward_.for_each_match(state, [&](const size_t pattern) { on_match(aho_match { pattern, i + 1 - lengths_[pattern] }); });
+        }
+    }
+
+    // the match that ends first
+    constexpr std::optional<aho_match> find_first(const std::string_view text) const
+    {
+        uint16_t state = 0;
+
+        for (size_t i = 0; i < text.size(); ++i) {
+            state = forward_.advance(state, text[i]);
+            if (const auto pattern = forward_.longest_match(state))
+                return aho_match { *pattern, i + 1 - lengths_[*pattern] };
+        }
+
+        return std::nullopt;
+    }
+
+    // the match that starts last
+    constexpr std::optional<aho_match> find_last(const std::string_view text) const
+    {
+        uint16_t state = 0;
+
+        for (size_t i = text.size(); i > 0; --i) {
+            state = backward_.advance(state, text[i - 1]);
+            if (const auto pattern = backward_.longest_match(state))
+                return aho_match { *pattern, i - 1 };
+        }
+
+        return std::nullopt;
+    }
+
+private:
+    struct automaton {
+        static constexpr uint16_t absent = std::numeric_limits<uint16_t>::max();
+
+        std::array<std::array<uint16_t, 256>, NumStates> next {};
+        // pattern + 1 that ends in a state, 0 if none
+        std::array<uint16_t, NumStates> match {};
+        // closest state on the suffix link chain that has a match, 0 if none
+        std::array<uint16_t, NumStates> output_link {};
+
+        constexpr uint16_t advance(const uint16_t state, const char c) const
+        {
+            return next[state][static_cast<unsigned char>(c)];
+        }
+
+        constexpr std::optional<size_t> longest_match(const uint16_t state) const
+        {
+            const auto s = match[state] != 0 ? state : output_link[state];
+            return s != 0 ? std::optional<size_t> { match[s] - 1 } : std::nullopt;
+        }
+
+        constexpr void for_each_match(const uint16_t state, const auto& f) const
+        {
+            for (auto s = match[state] != 0 ? state : output_link[state]; s != 0; s = output_link[s])
+                f(size_t { match[s] - 1u });
+        }
+
+        constexpr void build(const std::array<std::string_view, NumPatterns>& patterns, const bool reversed)
+        {
+            for (auto& transitions : next)
+                transitions.fill(absent);
+
+            uint16_t num_states = 1;
+
+            for (size_t pattern = 0; pattern < NumPatterns; ++pattern) {
+                uint16_t state = 0;
+
+                for (size_t i = 0; i < patterns[pattern].size(); ++i) {
+                    const auto c = static_cast<unsigned char>(patterns[pattern][reversed ? patterns[pattern].size() - 1 - i : i]);
+
+                    if (next[state][c] == absent)
+                        next[state][c] = num_states++;
+
+                    state = next[state][c];
+                }
+
+                if (match[state] == 0)
+                    match[state] = static_cast<uint16_t>(pattern + 1);
+            }
+
+            // breadth first over the trie, missing transitions are resolved through the suffix links
+            std::array<uint16_t, NumStates> suffix_link {};
+            std::array<uint16_t, NumStates> queue {};
+            size_t queue_begin = 0;
+            size_t queue_end = 0;
+
+            for (auto& target : next[0]) {
+                if (target == absent)
+                    target = 0;
+                else
+                    queue[queue_end++] = target;
+            }
+
+            while (queue_begin != queue_end) {
+                const auto state = queue[queue_begin++];
+                const auto link = suffix_link[state];
+
+                output_link[state] = match[link] != 0 ? link : output_link[link];
+
+                for (size_t c = 0; c < 256; ++c) {
+                    auto& target = next[state][c];
+
+                    if (target == absent) {
+                        target = next[link][c];
+                    } else {
+                        suffix_link[target] = next[link][c];
+                        queue[queue_end++] = target;
+                    }
+                }
+            }
+        }
+    };
+
+    std::array<size_t, NumPatterns> lengths_ {};
+    automaton forward_;
+    automaton backward_;
+};
+
 inline std::string read_file(const std::filesystem::path& p)
 {
     std::ifstream ifs(p);
@@ -67,7 +234,7 @@ template <typename T>
 struct simple_mdarray {
     using value_type = T;
 
-    simple_mdarray(const size_t rows, const size_t cols)
+    constexpr simple_mdarray(const size_t rows, const size_t cols)
         : rows_(rows)
         , cols_(cols)
         , data_(rows * cols)